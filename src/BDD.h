@@ -0,0 +1,164 @@
+// Reference counted handle for BDD nodes of a Manager
+//
+
+#ifndef VDSPROJECT_BDD_H
+#define VDSPROJECT_BDD_H
+
+#include "Manager.h"
+#include <utility>
+
+namespace ClassProject {
+
+    /**
+     * BDD is a lightweight value type bound to a Manager. While a handle exists, the node it names is
+     * referenced and survives Manager::garbageCollect. Copies add a reference, moves transfer it.
+     * A default constructed handle is empty and holds nothing.
+     */
+    class BDD {
+    private:
+        Manager *mgr = nullptr;
+        BDD_ID node = FalseId;
+
+        // Both operands must live in the same manager
+        Manager &common(const BDD &rhs) const
+        {
+            if (mgr == nullptr || mgr != rhs.mgr) {
+                throw std::runtime_error("BDD operands belong to different managers.");
+            }
+            return *mgr;
+        }
+
+    public:
+        BDD() = default;
+
+        BDD(Manager &manager, const BDD_ID id) : mgr(&manager), node(id)
+        {
+            mgr->ref(node);
+        }
+
+        BDD(const BDD &other) : mgr(other.mgr), node(other.node)
+        {
+            if (mgr != nullptr) {
+                mgr->ref(node);
+            }
+        }
+
+        BDD(BDD &&other) noexcept : mgr(std::exchange(other.mgr, nullptr)), node(other.node) {}
+
+        BDD &operator=(const BDD &other)
+        {
+            BDD copy(other);
+            swap(copy);
+            return *this;
+        }
+
+        BDD &operator=(BDD &&other) noexcept
+        {
+            BDD moved(std::move(other));
+            swap(moved);
+            return *this;
+        }
+
+        ~BDD()
+        {
+            if (mgr != nullptr) {
+                mgr->deref(node);
+            }
+        }
+
+        void swap(BDD &other) noexcept
+        {
+            std::swap(mgr, other.mgr);
+            std::swap(node, other.node);
+        }
+
+        // Raw ID of the referenced node
+        BDD_ID id() const
+        {
+            return node;
+        }
+
+        // Manager the handle is bound to, nullptr for an empty handle
+        Manager *manager() const
+        {
+            return mgr;
+        }
+
+        bool isConstant() const
+        {
+            return node == TrueId || node == FalseId;
+        }
+
+        BDD operator~() const
+        {
+            return BDD(common(*this), mgr->neg(node));
+        }
+
+        BDD operator&(const BDD &rhs) const
+        {
+            return BDD(common(rhs), mgr->and2(node, rhs.node));
+        }
+
+        BDD operator|(const BDD &rhs) const
+        {
+            return BDD(common(rhs), mgr->or2(node, rhs.node));
+        }
+
+        BDD operator^(const BDD &rhs) const
+        {
+            return BDD(common(rhs), mgr->xor2(node, rhs.node));
+        }
+
+        BDD &operator&=(const BDD &rhs)
+        {
+            return *this = *this & rhs;
+        }
+
+        BDD &operator|=(const BDD &rhs)
+        {
+            return *this = *this | rhs;
+        }
+
+        BDD &operator^=(const BDD &rhs)
+        {
+            return *this = *this ^ rhs;
+        }
+
+        // this ? t : e
+        BDD ite(const BDD &t, const BDD &e) const
+        {
+            common(t);
+            return BDD(common(e), mgr->ite(node, t.node, e.node));
+        }
+
+        BDD coFactorTrue(const BDD_ID x) const
+        {
+            return BDD(common(*this), mgr->coFactorTrue(node, x));
+        }
+
+        BDD coFactorFalse(const BDD_ID x) const
+        {
+            return BDD(common(*this), mgr->coFactorFalse(node, x));
+        }
+
+        // Handles are equal if they name the same node of the same manager (canonicity of ROBDDs)
+        bool operator==(const BDD &rhs) const
+        {
+            return mgr == rhs.mgr && node == rhs.node;
+        }
+
+        bool operator!=(const BDD &rhs) const
+        {
+            return !(*this == rhs);
+        }
+    };
+
+    // i ? t : e
+    inline BDD ite(const BDD &i, const BDD &t, const BDD &e)
+    {
+        return i.ite(t, e);
+    }
+
+}
+
+#endif
@@ -1,5 +1,7 @@
 #include "Manager.h"
 #include <algorithm>
+#include <map>
+#include <functional>
 
 namespace ClassProject {
 
@@ -10,177 +12,534 @@ namespace ClassProject {
 
     // Initialize the unique table
     void Manager::init_unique_tb() {
-        unique_tb.emplace(uniqueTableSize(), uTableRow {False(), False(), False()});
+        unique_tb.emplace_back(False(), False(), False());
         rev_uniq_tb[uTableRow {False(), False(), False()}] = False();
-        unique_tb.emplace(uniqueTableSize(), uTableRow{True(), True(), True()});
+        unique_tb.emplace_back(True(), True(), True());
         rev_uniq_tb[uTableRow{True(), True(), True()}] = True();
+        VDS_STAT(counters.peakNodes = uniqueTableSize());
     }
 
+#ifdef VDS_MANAGER_STATS
+    // Record the bucket length probed by a unique table lookup
+    void Manager::count_unique_probe(const uTableRow &row) {
+        const uint64_t probe = rev_uniq_tb.bucket_size(rev_uniq_tb.bucket(row));
+        counters.uniqueLookups++;
+        counters.uniqueProbeLength += probe;
+        counters.uniqueMaxProbeLength = std::max(counters.uniqueMaxProbeLength, probe);
+    }
+#endif
+
     // Create a new variable
     BDD_ID Manager::createVar(const std::string &label) {
         const BDD_ID id = get_nextID();
-        unique_tb.emplace(uniqueTableSize(), uTableRow{True(), False(), id});
+        unique_tb.emplace_back(True(), False(), id);
         rev_uniq_tb[uTableRow{True(), False(), id}] = id;
-        return id;
-    }
 
-    // Return the BDD ID for True
-    const BDD_ID &Manager::True() {
-        return TrueId;
+        // Intern the label
+        var_label.emplace(id, label_offsets.size() - 1);
+        label_pool.append(label);
+        label_offsets.push_back(label_pool.size());
+        VDS_STAT(counters.uniqueInserts++);
+        VDS_STAT(counters.peakNodes = std::max<uint64_t>(counters.peakNodes, uniqueTableSize()));
+        return id;
     }
 
-    // Return the BDD ID for False
-    const BDD_ID &Manager::False() {
-        return FalseId;
-    }
+    // Return the node (x, high, low), creating it if it is not in the unique table yet
+    BDD_ID Manager::find_or_add(const BDD_ID x, const BDD_ID high, const BDD_ID low) {
+        const uTableRow row(high, low, x);
+        VDS_STAT(count_unique_probe(row));
+        const auto uniq_entry = rev_uniq_tb.find(row);
+        if (uniq_entry != rev_uniq_tb.end()) {
+            return uniq_entry->second;
+        }
+        if (base) {
+            const BDD_ID frozen = frozen_unique(row);
+            if (frozen != InvalidId) {
+                return frozen;
+            }
+        }
 
-    // Determine if a node is a constant
-    bool Manager::isConstant(const BDD_ID f) {
-        return (f == True() || f == False());
+        // Entry not found -> add entry, reusing a reclaimed slot if there is one
+        if (get_nextID() >= node_limit) {
+            throw NodeLimitExceeded{};
+        }
+        BDD_ID new_id;
+        if (free_ids.empty() || !checkpoints.empty()) {
+            new_id = get_nextID();
+            unique_tb.push_back(row);
+        } else {
+            new_id = free_ids.back();
+            free_ids.pop_back();
+            unique_tb[new_id - base_size] = row;
+        }
+        rev_uniq_tb.emplace(row, new_id);
+        VDS_STAT(counters.uniqueInserts++);
+        VDS_STAT(counters.peakNodes = std::max<uint64_t>(counters.peakNodes, uniqueTableSize()));
+        return new_id;
     }
 
-    // Determine if a node is a variable
-    bool Manager::isVariable(const BDD_ID x) {
-        return unique_tb.at(x).topVar == x && !isConstant(x);
+    // ITE (if-then-else) operation
+    BDD_ID Manager::ite(const BDD_ID i, const BDD_ID t, const BDD_ID e) {
+        return ite_rec(checked(i), checked(t), checked(e));
     }
 
-    // Get the top variable of a node
-    BDD_ID Manager::topVar(const BDD_ID f) {
-        return unique_tb.at(f).topVar;
-    }
+    BDD_ID Manager::ite_rec(const BDD_ID i, const BDD_ID t, const BDD_ID e) {
+        VDS_STAT(counters.iteCalls++);
 
-    // ITE (if-then-else) operation
-    BDD_ID Manager::ite(const BDD_ID i, const BDD_ID t, const BDD_ID e) {
         // Check for terminal cases
         if (i == True()) {
+            VDS_STAT(counters.iteTerminalHits++);
             return t;
         }
         if (i == False()) {
+            VDS_STAT(counters.iteTerminalHits++);
             return e;
         }
-        if (t == True() && e == False()) {
-            return i;
-        }
-        if (t == e) {
-            return t;
-        }
 
-        // Standard Triplets
-        //  ite( F, F, G) => ite( F, 1, G)
-        if (i == t && !isConstant(t)) {
-            return ite(i, True(), e);
-        }
-        
-        //ite( F, G, F) => ite( F, G, 0)
-        if (i == e) {
-            return ite(i, t, False());
-        }
+        // Bring the triple into its canonical form, so equivalent calls share one computed table entry
+        BDD_ID ci = i, ct = t, ce = e;
+        standard_triples(ci, ct, ce);
+        VDS_STAT(if (ci != i || ct != t || ce != e) counters.iteCanonicalized++);
 
-        //ite( F, G, !F) => ite( F, G, 1)
-        if (i == neg(e)){
-            return ite(i, t, True());
+        if (ct == True() && ce == False()) {
+            VDS_STAT(counters.iteTerminalHits++);
+            return ci;
         }
-
-        //ite( F, !F, G) => ite( F, 0, G)
-        if (i == neg(t)) {
-            return ite(i, False(), e);
+        if (ct == ce) {
+            VDS_STAT(counters.iteTerminalHits++);
+            return ct;
         }
 
         // Check if node already exists
-        const auto ite_entry = computed_tb.find(uTableRow(i, t, e));
-        if (ite_entry != computed_tb.end()) {
+        VDS_STAT(counters.computedLookups++);
+        const BDD_ID cached = find_result(uTableRow(ci, ct, ce));
+        if (cached != InvalidId) {
             // Entry found -> return result
-            return ite_entry->second;
+            VDS_STAT(counters.computedHits++);
+            return cached;
         }
+        VDS_STAT(counters.computedMisses++);
 
         // Find the smallest top index for x
-        BDD_ID x = topVar(i);
-        if (topVar(t) < x && isVariable(topVar(t))) {
-            x = topVar(t);
+        const BDD_ID top_t = node(ct).topVar;
+        const BDD_ID top_e = node(ce).topVar;
+        BDD_ID x = node(ci).topVar;
+        if (top_t < x && !isConstant(ct)) {
+            x = top_t;
         }
-        if (topVar(e) < x && isVariable(topVar(e))) {
-            x = topVar(e);
+        if (top_e < x && !isConstant(ce)) {
+            x = top_e;
         }
 
         // Calculate r_high and r_low like Slide 2-17 VDS Lecture
-        const BDD_ID high = ite(coFactorTrue(i, x), coFactorTrue(t, x), coFactorTrue(e, x));
-        const BDD_ID low = ite(coFactorFalse(i, x), coFactorFalse(t, x), coFactorFalse(e, x));
+        const BDD_ID high = ite_rec(co_factor_true_rec(ci, x), co_factor_true_rec(ct, x), co_factor_true_rec(ce, x));
+        const BDD_ID low = ite_rec(co_factor_false_rec(ci, x), co_factor_false_rec(ct, x), co_factor_false_rec(ce, x));
 
-        if (high == low) {
-            computed_tb[uTableRow(i, t, e)] = high;
-            return high;
+        const BDD_ID result = (high == low) ? high : find_or_add(x, high, low);
+        cache_result(uTableRow(ci, ct, ce), result);
+        return result;
+    }
+
+    // ITE with a selectable evaluation order
+    BDD_ID Manager::ite(const BDD_ID i, const BDD_ID t, const BDD_ID e, const ApplyMode mode) {
+        if (mode == ApplyMode::BreadthFirst) {
+            return ite_breadth_first(checked(i), checked(t), checked(e));
         }
+        return ite_rec(checked(i), checked(t), checked(e));
+    }
 
-        const auto uniq_entry = rev_uniq_tb.find(uTableRow(high, low, x));
-        if (uniq_entry != rev_uniq_tb.end()) {
-            computed_tb[uTableRow(i, t, e)] = uniq_entry->second;
-            return uniq_entry->second;
+    // Breadth-first ITE: an expansion phase walks the variable levels top-down and turns every request
+    // into the requests for its two cofactors, a reduction phase walks the levels bottom-up and creates
+    // the result nodes. Requests are shared through a request table and answered from the computed
+    // table where possible, like in the recursive version.
+    BDD_ID Manager::ite_breadth_first(const BDD_ID i, const BDD_ID t, const BDD_ID e) {
+        // An operand of a request is either a finished node or another request
+        struct Operand {
+            bool pending;
+            size_t value; // BDD_ID if finished, request index otherwise
+        };
+        struct Request {
+            uTableRow triple; // canonical (i, t, e)
+            BDD_ID x;         // top variable of the triple
+            Operand high{false, 0};
+            Operand low{false, 0};
+            BDD_ID result = InvalidId;
+        };
+        std::vector<Request> requests;
+        std::unordered_map<uTableRow, size_t, uTableRowHash> request_tb;
+        std::map<BDD_ID, std::vector<size_t>> levels; // top variable -> requests at that level
+
+        // Resolve a triple from terminal cases or the computed table, or queue it as a request
+        auto make_operand = [&](BDD_ID ci, BDD_ID ct, BDD_ID ce) -> Operand {
+            VDS_STAT(counters.iteCalls++);
+            if (ci == True()) {
+                VDS_STAT(counters.iteTerminalHits++);
+                return {false, ct};
+            }
+            if (ci == False()) {
+                VDS_STAT(counters.iteTerminalHits++);
+                return {false, ce};
+            }
+            standard_triples(ci, ct, ce);
+            if (ct == True() && ce == False()) {
+                VDS_STAT(counters.iteTerminalHits++);
+                return {false, ci};
+            }
+            if (ct == ce) {
+                VDS_STAT(counters.iteTerminalHits++);
+                return {false, ct};
+            }
+            const uTableRow triple(ci, ct, ce);
+            VDS_STAT(counters.computedLookups++);
+            const BDD_ID cached = find_result(triple);
+            if (cached != InvalidId) {
+                VDS_STAT(counters.computedHits++);
+                return {false, cached};
+            }
+            const auto queued = request_tb.find(triple);
+            if (queued != request_tb.end()) {
+                return {true, queued->second};
+            }
+            VDS_STAT(counters.computedMisses++);
+
+            BDD_ID x = node(ci).topVar;
+            if (!isConstant(ct)) {
+                x = std::min(x, node(ct).topVar);
+            }
+            if (!isConstant(ce)) {
+                x = std::min(x, node(ce).topVar);
+            }
+            const size_t index = requests.size();
+            requests.push_back(Request{triple, x});
+            request_tb.emplace(triple, index);
+            levels[x].push_back(index);
+            return {true, index};
+        };
+
+        const Operand root = make_operand(i, t, e);
+        if (!root.pending) {
+            return root.value;
+        }
+
+        // Expansion: top-down, one level at a time. Children always lie on deeper levels.
+        for (auto level = levels.begin(); level != levels.end(); ++level) {
+            const BDD_ID x = level->first;
+            for (size_t k = 0; k < level->second.size(); ++k) {
+                const size_t index = level->second[k];
+                const uTableRow triple = requests[index].triple;
+                const BDD_ID ri = triple.high, rt = triple.low, re = triple.topVar;
+                const Operand high = make_operand(co_factor_true_rec(ri, x), co_factor_true_rec(rt, x),
+                                                  co_factor_true_rec(re, x));
+                const Operand low = make_operand(co_factor_false_rec(ri, x), co_factor_false_rec(rt, x),
+                                                 co_factor_false_rec(re, x));
+                requests[index].high = high;
+                requests[index].low = low;
+            }
         }
 
-        // Entry not found
-        // Add Entry
-        const BDD_ID new_id = get_nextID();
-        auto temp_2 = uTableRow(high, low, x);
-        computed_tb.emplace(uTableRow(i, t, e), new_id);
-        unique_tb.emplace(new_id, uTableRow(high, low, x));
-        rev_uniq_tb[uTableRow{high, low, x}] = new_id;
+        // Reduction: bottom-up, one level at a time
+        auto resolve = [&](const Operand &op) {
+            return op.pending ? requests[op.value].result : static_cast<BDD_ID>(op.value);
+        };
+        for (auto level = levels.rbegin(); level != levels.rend(); ++level) {
+            for (const size_t index : level->second) {
+                Request &request = requests[index];
+                const BDD_ID high = resolve(request.high);
+                const BDD_ID low = resolve(request.low);
+                request.result = (high == low) ? high : find_or_add(request.x, high, low);
+                cache_result(request.triple, request.result);
+            }
+        }
 
-        return new_id;
+        return requests[root.value].result;
     }
 
     // Compute the cofactor of a node with respect to a variable (true branch)
-    BDD_ID Manager::coFactorTrue(const BDD_ID f, BDD_ID x) {
+    BDD_ID Manager::coFactorTrue(const BDD_ID f, const BDD_ID x) {
+        return co_factor_true_rec(checked(f), checked(x));
+    }
+
+    BDD_ID Manager::co_factor_true_rec(const BDD_ID f, const BDD_ID x) {
+        const uTableRow n = node(f); // copy, the recursion may grow the unique table
 
         // Check for terminal Case and relevancy of x
-        if (isConstant(f) || topVar(f) > x || isConstant(x)) {
+        if (isConstant(f) || n.topVar > x || isConstant(x)) {
             return f;
         }
 
         // CoFactor of f w.r.t x is high path (Terminal Case)
-        if (topVar(f) == x) {
-            return unique_tb.at(f).high;
+        if (n.topVar == x) {
+            return n.high;
         }
 
         // Recursive high and low
-        BDD_ID high = coFactorTrue(unique_tb.at(f).high, x);
-        BDD_ID low = coFactorTrue(unique_tb.at(f).low, x);
+        const BDD_ID top = n.topVar;
+        const BDD_ID high = co_factor_true_rec(n.high, x);
+        const BDD_ID low = co_factor_true_rec(n.low, x);
         if (high == low) {
             return high;
         }
-        return ite(topVar(f), high, low);
+        return ite_rec(top, high, low);
     }
 
     // Compute the cofactor of a node with respect to a variable (false branch)
-    BDD_ID Manager::coFactorFalse(const BDD_ID f, BDD_ID x) {
-        if (isConstant(f) || topVar(f) > x || isConstant(x)) {
+    BDD_ID Manager::coFactorFalse(const BDD_ID f, const BDD_ID x) {
+        return co_factor_false_rec(checked(f), checked(x));
+    }
+
+    BDD_ID Manager::co_factor_false_rec(const BDD_ID f, const BDD_ID x) {
+        const uTableRow n = node(f); // copy, the recursion may grow the unique table
+
+        if (isConstant(f) || n.topVar > x || isConstant(x)) {
             return f;
         }
 
         // CoFactor of f w.r.t x is low path (Terminal Case)
-        if (topVar(f) == x) {
-            return unique_tb.at(f).low;
+        if (n.topVar == x) {
+            return n.low;
         }
 
         // Recursive high and low
-        BDD_ID high = coFactorFalse(unique_tb.at(f).high, x);
-        BDD_ID low = coFactorFalse(unique_tb.at(f).low, x);
+        const BDD_ID top = n.topVar;
+        const BDD_ID high = co_factor_false_rec(n.high, x);
+        const BDD_ID low = co_factor_false_rec(n.low, x);
 
         // Check for terminal case
         if (high == low) {
             return high;
         }
 
-        return ite(topVar(f), high, low);
+        return ite_rec(top, high, low);
     }
 
-    // Compute the cofactor of a node (true branch)
-    BDD_ID Manager::coFactorTrue(const BDD_ID f) {
-        return unique_tb.at(f).high;
+    // Simplify f with the care set c
+    BDD_ID Manager::restrict(const BDD_ID f, const BDD_ID c) {
+        checked(f);
+        if (checked(c) == False()) {
+            return f;
+        }
+        std::unordered_map<uTableRow, BDD_ID, uTableRowHash> memo;
+        return restrict_rec(f, c, memo);
     }
 
-    // Compute the cofactor of a node (false branch)
-    BDD_ID Manager::coFactorFalse(const BDD_ID f) {
-        return unique_tb.at(f).low;
+    BDD_ID Manager::restrict_rec(const BDD_ID f, const BDD_ID c,
+                                 std::unordered_map<uTableRow, BDD_ID, uTableRowHash> &memo) {
+        if (c == True() || isConstant(f)) {
+            return f;
+        }
+        if (f == c) {
+            return True();
+        }
+        const uTableRow key(f, c, 0);
+        const auto known = memo.find(key);
+        if (known != memo.end()) {
+            return known->second;
+        }
+
+        const uTableRow nf = node(f); // copies, the recursion may grow the unique table
+        const uTableRow nc = node(c);
+        BDD_ID result;
+        if (nc.topVar < nf.topVar) {
+            // f does not depend on the top variable of c, quantify it out of the care set
+            result = restrict_rec(f, ite_rec(nc.high, True(), nc.low), memo);
+        } else {
+            const BDD_ID x = nf.topVar;
+            const BDD_ID c_high = nc.topVar == x ? nc.high : c;
+            const BDD_ID c_low = nc.topVar == x ? nc.low : c;
+            if (c_high == False()) {
+                result = restrict_rec(nf.low, c_low, memo);
+            } else if (c_low == False()) {
+                result = restrict_rec(nf.high, c_high, memo);
+            } else {
+                result = make_node(x, restrict_rec(nf.high, c_high, memo), restrict_rec(nf.low, c_low, memo));
+            }
+        }
+        memo.emplace(key, result);
+        return result;
+    }
+
+    // Satisfiability of a conjunction without building it
+    bool Manager::intersects(const BDD_ID f, const BDD_ID g) {
+        std::unordered_set<uTableRow, uTableRowHash> disjoint;
+        return intersects_rec(checked(f), checked(g), disjoint);
+    }
+
+    bool Manager::intersects_rec(BDD_ID f, BDD_ID g, std::unordered_set<uTableRow, uTableRowHash> &disjoint) {
+        if (f == False() || g == False()) {
+            return false;
+        }
+        if (f == True() || g == True() || f == g) {
+            return true;
+        }
+        if (f > g) {
+            swapID(f, g);
+        }
+        // Only disjoint pairs are remembered, an intersecting pair ends the search
+        const uTableRow key(f, g, 0);
+        if (disjoint.count(key)) {
+            return false;
+        }
+        const uTableRow &nf = node(f);
+        const uTableRow &ng = node(g);
+        const BDD_ID x = std::min(nf.topVar, ng.topVar);
+        const BDD_ID f_high = nf.topVar == x ? nf.high : f, f_low = nf.topVar == x ? nf.low : f;
+        const BDD_ID g_high = ng.topVar == x ? ng.high : g, g_low = ng.topVar == x ? ng.low : g;
+        if (intersects_rec(f_high, g_high, disjoint) || intersects_rec(f_low, g_low, disjoint)) {
+            return true;
+        }
+        disjoint.insert(key);
+        return false;
+    }
+
+    // Simultaneous substitution of functions for variables
+    BDD_ID Manager::vectorCompose(const BDD_ID f, const std::unordered_map<BDD_ID, BDD_ID> &substitution) {
+        for (const auto &[var, g] : substitution) {
+            checked(var);
+            checked(g);
+        }
+        std::unordered_map<BDD_ID, BDD_ID> memo;
+        return compose_rec(checked(f), substitution, memo);
+    }
+
+    BDD_ID Manager::compose_rec(const BDD_ID f, const std::unordered_map<BDD_ID, BDD_ID> &substitution,
+                                std::unordered_map<BDD_ID, BDD_ID> &memo) {
+        if (isConstant(f)) {
+            return f;
+        }
+        const auto known = memo.find(f);
+        if (known != memo.end()) {
+            return known->second;
+        }
+        const uTableRow n = node(f); // copy, the recursion may grow the unique table
+        const auto replaced = substitution.find(n.topVar);
+        const BDD_ID g = replaced != substitution.end() ? replaced->second : n.topVar;
+        const BDD_ID high = compose_rec(n.high, substitution, memo);
+        const BDD_ID low = compose_rec(n.low, substitution, memo);
+        const BDD_ID result = ite_rec(g, high, low);
+        memo.emplace(f, result);
+        return result;
+    }
+
+    // Cube of literals, built from the lowest variable up
+    BDD_ID Manager::cube(const std::vector<BDD_ID> &vars, const std::vector<bool> &values) {
+        if (!values.empty() && values.size() != vars.size()) {
+            throw std::runtime_error("Cube needs one value per variable.");
+        }
+        std::vector<std::pair<BDD_ID, bool>> literals;
+        literals.reserve(vars.size());
+        for (size_t i = 0; i < vars.size(); ++i) {
+            if (!isVariable(vars[i])) {
+                throw std::runtime_error("Cube literal " + std::to_string(vars[i]) + " is not a variable.");
+            }
+            literals.emplace_back(vars[i], values.empty() || values[i]);
+        }
+        std::sort(literals.begin(), literals.end(), std::greater<>());
+
+        // Every literal sits above the cube built so far, so each node can be created directly
+        BDD_ID result = TrueId;
+        for (size_t i = 0; i < literals.size(); ++i) {
+            if (i > 0 && literals[i].first == literals[i - 1].first) {
+                throw std::runtime_error("Cube variable " + std::to_string(literals[i].first) + " appears twice.");
+            }
+            const BDD_ID x = literals[i].first;
+            result = literals[i].second ? find_or_add(x, result, FalseId) : find_or_add(x, FalseId, result);
+        }
+        return result;
+    }
+
+    // Existential quantification of a cube of variables
+    BDD_ID Manager::exists(const BDD_ID f, const BDD_ID cube) {
+        std::unordered_map<uTableRow, BDD_ID, uTableRowHash> memo;
+        return exists_rec(checked(f), checked(cube), memo);
+    }
+
+    BDD_ID Manager::exists_rec(const BDD_ID f, BDD_ID cube,
+                               std::unordered_map<uTableRow, BDD_ID, uTableRowHash> &memo) {
+        if (isConstant(f)) {
+            return f;
+        }
+        // Skip quantified variables above f
+        const uTableRow n = node(f);
+        while (!isConstant(cube) && node(cube).topVar < n.topVar) {
+            cube = node(cube).high;
+        }
+        if (isConstant(cube)) {
+            return f;
+        }
+        const uTableRow key(f, cube, 0);
+        const auto known = memo.find(key);
+        if (known != memo.end()) {
+            return known->second;
+        }
+
+        BDD_ID result;
+        if (node(cube).topVar == n.topVar) {
+            const BDD_ID rest = node(cube).high;
+            const BDD_ID high = exists_rec(n.high, rest, memo);
+            result = (high == True()) ? True() : ite_rec(high, True(), exists_rec(n.low, rest, memo));
+        } else {
+            result = make_node(n.topVar, exists_rec(n.high, cube, memo), exists_rec(n.low, cube, memo));
+        }
+        memo.emplace(key, result);
+        return result;
+    }
+
+    // Relational product exists(f & g, cube)
+    BDD_ID Manager::andExists(const BDD_ID f, const BDD_ID g, const BDD_ID cube) {
+        std::unordered_map<uTableRow, BDD_ID, uTableRowHash> memo, exists_memo;
+        return and_exists_rec(checked(f), checked(g), checked(cube), memo, exists_memo);
+    }
+
+    BDD_ID Manager::and_exists_rec(BDD_ID f, BDD_ID g, BDD_ID cube,
+                                   std::unordered_map<uTableRow, BDD_ID, uTableRowHash> &memo,
+                                   std::unordered_map<uTableRow, BDD_ID, uTableRowHash> &exists_memo) {
+        // Terminal cases
+        if (f == False() || g == False()) {
+            return False();
+        }
+        if (f == True() || f == g) {
+            return exists_rec(g, cube, exists_memo);
+        }
+        if (g == True()) {
+            return exists_rec(f, cube, exists_memo);
+        }
+        if (cube == True()) {
+            return ite_rec(f, g, False());
+        }
+        if (f > g) {
+            swapID(f, g); // conjunction is commutative, share one memo entry
+        }
+
+        // Skip quantified variables above both operands
+        const uTableRow nf = node(f); // copies, the recursion may grow the unique table
+        const uTableRow ng = node(g);
+        const BDD_ID x = std::min(nf.topVar, ng.topVar);
+        while (!isConstant(cube) && node(cube).topVar < x) {
+            cube = node(cube).high;
+        }
+        if (isConstant(cube)) {
+            return ite_rec(f, g, False());
+        }
+        const uTableRow key(f, g, cube);
+        const auto known = memo.find(key);
+        if (known != memo.end()) {
+            return known->second;
+        }
+
+        const BDD_ID f_high = nf.topVar == x ? nf.high : f, f_low = nf.topVar == x ? nf.low : f;
+        const BDD_ID g_high = ng.topVar == x ? ng.high : g, g_low = ng.topVar == x ? ng.low : g;
+        BDD_ID result;
+        if (node(cube).topVar == x) {
+            const BDD_ID rest = node(cube).high;
+            const BDD_ID high = and_exists_rec(f_high, g_high, rest, memo, exists_memo);
+            result = (high == True()) ? True()
+                                      : ite_rec(high, True(), and_exists_rec(f_low, g_low, rest, memo, exists_memo));
+        } else {
+            result = make_node(x, and_exists_rec(f_high, g_high, cube, memo, exists_memo),
+                               and_exists_rec(f_low, g_low, cube, memo, exists_memo));
+        }
+        memo.emplace(key, result);
+        return result;
     }
 
     // Swap two BDD IDs
@@ -190,122 +549,123 @@ namespace ClassProject {
         b = temp;
     }
 
+    // Rewrite an ite triple into its canonical form (Brace, Rudell, Bryant). Only rules that need no
+    // negation are applied: without complement edges, !F would have to be built as a new BDD first.
     void Manager::standard_triples(BDD_ID &i, BDD_ID &t, BDD_ID &e){
-        //First, the following simplifications are applied to the arguments of the ite where possible:
-
         //ite( F, F, G) => ite( F, 1, G)
         if (i == t) {
             t = True();
         }
-        //ite( F, G, F) => ite( F, G, 0) 
+        //ite( F, G, F) => ite( F, G, 0)
         else if (i == e) {
             e = False();
-        } 
-        //ite( F, G, !F) => ite( F, G, 1)
-        else if (i == neg(e)) {
-            e = True();
-        } 
-        //ite( F, !F, G) => ite( F, 0, G)
-        else if (i == neg(t)) {
-            t = False();
-        }
-        
+        }
+
         //ite( F, 1, G) = ite( G, 1, F)
-        if (t == True() && i > e) {
-            swapID(i, e);
-        } 
-        //ite( F, G, 0) = ite( F, G, 0)
-        else if (e == False() && i > t) {
-            swapID(i, t);
-        } 
-        //ite( F, G, 1) = ite( !G, !F, 1)
-        else if (e == True() && i > t) {
-            i = neg(i);
-            t = neg(t);
-            swapID(i, t);
-        } 
-        //ite( F, 0, G) = ite( !G, 0, !F)
-        else if (t == False() && i > e) {
-            e = neg(e);
-            i = neg(i);
+        if (t == True() && i > e && !isConstant(e)) {
             swapID(i, e);
-        } 
-        //ite( F, G, !G) = ite( G, F, !F)
-        else if (e == neg(t) && i > t) {
-            e = neg(i);
-            swapID(i, t);
         }
-
-        // Complement edges lead to the following equivalences:
-        // F != G != H
-        if (i != t && i != e && t != e) {    
-        
-        // ite(F,G,H) = ite(!F,H,G)
-            if (t > e) {                     
-                i = neg(i);
-                swapID(t, e);
-            }
+        //ite( F, G, 0) = ite( G, F, 0)
+        else if (e == False() && i > t && !isConstant(t)) {
+            swapID(i, t);
         }
     }
 
     // Slide 2-15
     BDD_ID Manager::and2(const BDD_ID a, const BDD_ID b) {
-        return ite(a, b, False());
+        return ite_rec(checked(a), checked(b), False());
     }
 
     // Slide 2-15
     BDD_ID Manager::or2(const BDD_ID a, const BDD_ID b) {
-        return ite(a, True(), b);
+        return ite_rec(checked(a), True(), checked(b));
+    }
+
+    BDD_ID Manager::and2(const BDD_ID a, const BDD_ID b, const ApplyMode mode) {
+        return ite(a, b, False(), mode);
+    }
+
+    // AND operation that gives up after limit new nodes
+    BDD_ID Manager::andLimit(const BDD_ID a, const BDD_ID b, const size_t limit) {
+        return andLimit(a, b, limit, ApplyMode::DepthFirst);
+    }
+
+    BDD_ID Manager::andLimit(const BDD_ID a, const BDD_ID b, const size_t limit, const ApplyMode mode) {
+        checked(a);
+        checked(b);
+        const Checkpoint mark = checkpoint();
+        const BDD_ID outer_limit = node_limit;
+        node_limit = std::min<BDD_ID>(outer_limit, mark.nodes + std::min<size_t>(limit, InvalidId - mark.nodes));
+        try {
+            const BDD_ID result =
+                mode == ApplyMode::BreadthFirst ? ite_breadth_first(a, b, False()) : ite_rec(a, b, False());
+            node_limit = outer_limit;
+            commit(mark);
+            return result;
+        } catch (const NodeLimitExceeded &) {
+            node_limit = outer_limit;
+            rollback(mark);
+            return InvalidId;
+        }
+    }
+
+    BDD_ID Manager::or2(const BDD_ID a, const BDD_ID b, const ApplyMode mode) {
+        return ite(a, True(), b, mode);
     }
 
     // Slide 2-15
     BDD_ID Manager::xor2(const BDD_ID a, const BDD_ID b) {
-        return ite(a, neg(b), b);
+        checked(a);
+        return ite_rec(a, ite_rec(checked(b), False(), True()), b);
     }
 
     // Slide 2-15
     BDD_ID Manager::neg(const BDD_ID a) {
-        return ite(a, False(), True());
+        return ite_rec(checked(a), False(), True());
     }
 
     // Abb. 4 https://agra.informatik.uni-bremen.de/doc/software/manual/index.html
     BDD_ID Manager::nand2(const BDD_ID a, const BDD_ID b) {
-        return ite(a, neg(b), True());
+        checked(a);
+        return ite_rec(a, ite_rec(checked(b), False(), True()), True());
     }
 
     // Abb. 4 https://agra.informatik.uni-bremen.de/doc/software/manual/index.html
     BDD_ID Manager::nor2(const BDD_ID a, const BDD_ID b) {
-        return ite(a, False(), neg(b));
+        checked(a);
+        return ite_rec(a, False(), ite_rec(checked(b), False(), True()));
     }
 
     // Abb. 4 https://agra.informatik.uni-bremen.de/doc/software/manual/index.html
     BDD_ID Manager::xnor2(const BDD_ID a, const BDD_ID b) {
-        return ite(a, b, neg(b));
+        checked(a);
+        return ite_rec(a, b, ite_rec(checked(b), False(), True()));
     }
 
     // Get the name of the top variable of a node
-    std::string Manager::getTopVarName(const BDD_ID &root) {
-        if (isConstant(root)) {
-            if(root == True()) {
-                return "True";
-            } else {
-                return "False";
-            }
-        } else if (isVariable(root)) {
-            return "x" + std::to_string(root);
+    std::string_view Manager::getTopVarName(const BDD_ID &root) {
+        if (root == True()) {
+            return "True";
         }
-        return "Is not a variable and no constant -> Is not supported";
+        if (root == False()) {
+            return "False";
+        }
+        const size_t label = var_label.at(topVar(root));
+        return std::string_view(label_pool).substr(label_offsets[label], label_offsets[label + 1] - label_offsets[label]);
     }
 
     void Manager::findNodes(const BDD_ID &root, std::set<BDD_ID> &nodes_of_root) {
-        // Attempt to add current node to the set
-        bool insert_successful = nodes_of_root.insert(root).second;
+        std::vector<BDD_ID> pending{checked(root)};
+        while (!pending.empty()) {
+            const BDD_ID current = pending.back();
+            pending.pop_back();
 
-        // Check if node is already processed
-        if (insert_successful) {
-            // Recursive call for following nodes (high and low)
-            findNodes(unique_tb.at(root).high, nodes_of_root);
-            findNodes(unique_tb.at(root).low, nodes_of_root);
+            // Attempt to add current node to the set, skip it if it is already processed
+            if (nodes_of_root.insert(current).second) {
+                // Continue with following nodes (high and low)
+                pending.push_back(node(current).high);
+                pending.push_back(node(current).low);
+            }
         }
     }
 
@@ -313,19 +673,605 @@ namespace ClassProject {
     void Manager::findVars(const BDD_ID &root, std::set<BDD_ID> &vars_of_root) {
         std::set<BDD_ID> nodes;
         findNodes(root, nodes);
-        for (const BDD_ID &node : nodes) {
-            BDD_ID top = topVar(node);
+        for (const BDD_ID &id : nodes) {
+            const BDD_ID top = node(id).topVar;
 
             // Check for terminal node
-            if (isVariable(top)) {
+            if (!isConstant(id)) {
                 vars_of_root.insert(top);
             }
         }
     }
 
-    // Get the size of the unique table
-    size_t Manager::uniqueTableSize() {
-        return unique_tb.size();
+    // Register one more BDD handle holding f
+    void Manager::ref(const BDD_ID f) {
+        checked(f);
+        if (f >= ref_counts.size()) {
+            ref_counts.resize(get_nextID(), 0);
+        }
+        ref_counts[f]++;
+    }
+
+    // Release one BDD handle holding f
+    void Manager::deref(const BDD_ID f) {
+        if (f < ref_counts.size() && ref_counts[f] > 0) {
+            ref_counts[f]--;
+        }
+    }
+
+    // Reclaim all nodes that are not reachable from a referenced node, a variable or a terminal
+    size_t Manager::garbageCollect() {
+        // Mark, frozen nodes are always live and only point to frozen nodes
+        std::vector<bool> live(get_nextID(), false);
+        std::fill(live.begin(), live.begin() + base_size, true);
+        std::vector<BDD_ID> pending;
+        for (BDD_ID id = base_size; id < get_nextID(); ++id) {
+            const uTableRow &row = node(id);
+            if (row.topVar == InvalidId) {
+                continue;
+            }
+            if (isConstant(id) || row.topVar == id || refCount(id) > 0) {
+                pending.push_back(id);
+            }
+        }
+        while (!pending.empty()) {
+            const BDD_ID current = pending.back();
+            pending.pop_back();
+            if (!live[current]) {
+                live[current] = true;
+                pending.push_back(node(current).high);
+                pending.push_back(node(current).low);
+            }
+        }
+
+        // Sweep the unique table
+        size_t reclaimed = 0;
+        for (BDD_ID id = base_size; id < get_nextID(); ++id) {
+            uTableRow &row = unique_tb[id - base_size];
+            if (!live[id] && row.topVar != InvalidId) {
+                rev_uniq_tb.erase(row);
+                row = uTableRow(InvalidId, InvalidId, InvalidId);
+                free_ids.push_back(id);
+                reclaimed++;
+            }
+        }
+
+        // Drop computed table entries that mention a reclaimed node
+        for (auto it = computed_tb.begin(); it != computed_tb.end();) {
+            const uTableRow &key = it->first;
+            if (live[key.high] && live[key.low] && live[key.topVar] && live[it->second]) {
+                ++it;
+            } else {
+                it = computed_tb.erase(it);
+                VDS_STAT(counters.computedEvictions++);
+            }
+        }
+
+        return reclaimed;
+    }
+
+    // Record the current high-water mark
+    Checkpoint Manager::checkpoint() {
+        checkpoints.push_back(Checkpoint{get_nextID(), label_offsets.size() - 1, checkpoints.size(),
+                                         computed_log.size()});
+        return checkpoints.back();
+    }
+
+    // Drop everything created since the checkpoint
+    void Manager::rollback(const Checkpoint &token) {
+        if (token.depth >= checkpoints.size() || checkpoints[token.depth].nodes != token.nodes) {
+            throw std::runtime_error("Rollback to a checkpoint that is not open.");
+        }
+        for (BDD_ID id = token.nodes; id < ref_counts.size(); ++id) {
+            if (ref_counts[id] > 0) {
+                throw std::runtime_error("Rollback would remove a node held by a BDD handle.");
+            }
+        }
+
+        // Computed table entries logged since the checkpoint that mention a removed node
+        for (size_t k = token.log; k < computed_log.size(); ++k) {
+            const uTableRow &key = computed_log[k];
+            const auto entry = computed_tb.find(key);
+            if (entry != computed_tb.end() && (key.high >= token.nodes || key.low >= token.nodes ||
+                                               key.topVar >= token.nodes || entry->second >= token.nodes)) {
+                computed_tb.erase(entry);
+                VDS_STAT(counters.computedEvictions++);
+            }
+        }
+
+        // Nodes and labels
+        for (BDD_ID id = token.nodes; id < get_nextID(); ++id) {
+            if (node(id).topVar != InvalidId) {
+                rev_uniq_tb.erase(node(id));
+            }
+            var_label.erase(id);
+        }
+        unique_tb.erase(unique_tb.begin() + (token.nodes - base_size), unique_tb.end());
+        ref_counts.resize(std::min(ref_counts.size(), token.nodes));
+        free_ids.erase(std::remove_if(free_ids.begin(), free_ids.end(),
+                                      [&](const BDD_ID id) { return id >= token.nodes; }), free_ids.end());
+        label_pool.resize(label_offsets[token.labels]);
+        label_offsets.resize(token.labels + 1);
+
+        checkpoints.resize(token.depth);
+        computed_log.erase(computed_log.begin() + (checkpoints.empty() ? 0 : token.log), computed_log.end());
+    }
+
+    // Close the checkpoint and keep its nodes
+    void Manager::commit(const Checkpoint &token) {
+        if (token.depth >= checkpoints.size() || checkpoints[token.depth].nodes != token.nodes) {
+            throw std::runtime_error("Commit of a checkpoint that is not open.");
+        }
+        checkpoints.resize(token.depth);
+        if (checkpoints.empty()) {
+            computed_log.clear();
+        }
+    }
+
+    // Frozen layer holding node f (f < base_size)
+    const uTableRow &Manager::frozen_node(const BDD_ID f) const {
+        const FrozenStore *layer = base.get();
+        while (f < layer->first) {
+            layer = layer->parent.get();
+        }
+#if VDS_MANAGER_CHECKED
+        return layer->nodes.at(f - layer->first);
+#else
+        return layer->nodes[f - layer->first];
+#endif
+    }
+
+    // Unique table lookup through all frozen layers, InvalidId if absent
+    BDD_ID Manager::frozen_unique(const uTableRow &row) const {
+        for (const FrozenStore *layer = base.get(); layer != nullptr; layer = layer->parent.get()) {
+            const auto entry = layer->unique.find(row);
+            if (entry != layer->unique.end()) {
+                return entry->second;
+            }
+        }
+        return InvalidId;
+    }
+
+    // Computed table lookup through all frozen layers, InvalidId if absent
+    BDD_ID Manager::frozen_result(const uTableRow &key) const {
+        for (const FrozenStore *layer = base.get(); layer != nullptr; layer = layer->parent.get()) {
+            const auto entry = layer->computed.find(key);
+            if (entry != layer->computed.end()) {
+                return entry->second;
+            }
+        }
+        return InvalidId;
+    }
+
+    // Move the current state into a new frozen layer, leaving an empty overlay. The layers below are
+    // shared, not copied. Lookups walk the chain, so once it is maxFrozenDepth layers deep the next
+    // freeze flattens it into a single layer (a full copy once every maxFrozenDepth forks).
+    void Manager::freeze() {
+        constexpr size_t maxFrozenDepth = 8;
+        if (unique_tb.empty() && computed_tb.empty()) {
+            return;
+        }
+        auto store = std::make_shared<FrozenStore>();
+        if (base && base->depth >= maxFrozenDepth) {
+            std::vector<const FrozenStore *> layers;
+            for (const FrozenStore *layer = base.get(); layer != nullptr; layer = layer->parent.get()) {
+                layers.push_back(layer);
+            }
+            store->nodes.reserve(get_nextID());
+            for (auto layer = layers.rbegin(); layer != layers.rend(); ++layer) {
+                store->nodes.insert(store->nodes.end(), (*layer)->nodes.begin(), (*layer)->nodes.end());
+                store->unique.insert((*layer)->unique.begin(), (*layer)->unique.end());
+                store->computed.insert((*layer)->computed.begin(), (*layer)->computed.end());
+            }
+            store->nodes.insert(store->nodes.end(), unique_tb.begin(), unique_tb.end());
+            store->freed = base->freed;
+        } else {
+            store->parent = base;
+            store->first = base_size;
+            store->depth = base ? base->depth + 1 : 1;
+            store->nodes = std::move(unique_tb);
+            store->freed = base ? base->freed : 0;
+        }
+        store->unique.merge(rev_uniq_tb);
+        store->computed.merge(computed_tb);
+        store->freed += free_ids.size();
+
+        unique_tb.clear();
+        rev_uniq_tb.clear();
+        computed_tb.clear();
+        free_ids.clear();
+        base_size = store->first + store->nodes.size();
+        base = std::move(store);
+    }
+
+    // Fork a manager sharing the frozen node store
+    std::unique_ptr<Manager> Manager::fork() {
+        if (!checkpoints.empty()) {
+            throw std::runtime_error("Cannot fork a Manager with an open checkpoint.");
+        }
+        freeze();
+        auto forked = std::make_unique<Manager>(*this);
+        // Handles of this manager do not hold nodes of the fork
+        forked->ref_counts.clear();
+        return forked;
+    }
+
+    // Copy a function from src into dst, translating variables through varMap
+    BDD_ID Manager::transfer(Manager &src, const BDD_ID root, Manager &dst,
+                             const std::unordered_map<BDD_ID, BDD_ID> &varMap) {
+        std::unordered_map<BDD_ID, BDD_ID> copied{{FalseId, FalseId}, {TrueId, TrueId}};
+        std::vector<BDD_ID> pending{src.checked(root)};
+        while (!pending.empty()) {
+            const BDD_ID current = pending.back();
+            if (copied.count(current)) {
+                pending.pop_back();
+                continue;
+            }
+            // Children first
+            const uTableRow n = src.node(current);
+            const auto high = copied.find(n.high);
+            const auto low = copied.find(n.low);
+            if (high == copied.end() || low == copied.end()) {
+                if (high == copied.end()) {
+                    pending.push_back(n.high);
+                }
+                if (low == copied.end()) {
+                    pending.push_back(n.low);
+                }
+                continue;
+            }
+            pending.pop_back();
+
+            const auto mapped = varMap.find(n.topVar);
+            if (mapped == varMap.end() || !dst.isVariable(mapped->second)) {
+                throw std::out_of_range("No variable mapping for BDD_ID " + std::to_string(n.topVar));
+            }
+            const BDD_ID x = mapped->second;
+            const BDD_ID h = high->second, l = low->second;
+
+            // Same relative order: the node can be created directly, otherwise let ite reorder it
+            BDD_ID result;
+            if ((dst.isConstant(h) || x < dst.node(h).topVar) && (dst.isConstant(l) || x < dst.node(l).topVar)) {
+                result = (h == l) ? h : dst.find_or_add(x, h, l);
+            } else {
+                result = dst.ite_rec(x, h, l);
+            }
+            copied.emplace(current, result);
+        }
+        return copied.at(root);
+    }
+
+    // Number of nodes reachable from f
+    size_t Manager::nodeCount(const BDD_ID f) {
+        std::unordered_set<BDD_ID> seen;
+        std::vector<BDD_ID> pending{checked(f)};
+        while (!pending.empty()) {
+            const BDD_ID current = pending.back();
+            pending.pop_back();
+            if (seen.insert(current).second) {
+                if (!isConstant(current)) {
+                    pending.push_back(node(current).high);
+                    pending.push_back(node(current).low);
+                }
+            }
+        }
+        return seen.size();
+    }
+
+    // Fraction of all assignments that satisfy f
+    double Manager::density(const BDD_ID f, std::unordered_map<BDD_ID, double> &memo) {
+        if (isConstant(f)) {
+            return f == True() ? 1.0 : 0.0;
+        }
+        const auto known = memo.find(f);
+        if (known != memo.end()) {
+            return known->second;
+        }
+        const uTableRow n = node(f);
+        const double d = 0.5 * density(n.high, memo) + 0.5 * density(n.low, memo);
+        memo.emplace(f, d);
+        return d;
+    }
+
+    // Node x ? high : low for children below x
+    BDD_ID Manager::make_node(const BDD_ID x, const BDD_ID high, const BDD_ID low) {
+        return high == low ? high : find_or_add(x, high, low);
+    }
+
+    // Heavy branch subsetting
+    BDD_ID Manager::heavyBranchSubset(const BDD_ID f, const size_t threshold) {
+        // One post-order pass: the size of a subgraph is at most one plus the sizes of its children
+        // (exact without sharing), saturated just above the threshold
+        const size_t cap = threshold + 1;
+        std::unordered_map<BDD_ID, size_t> bounds{{FalseId, 1}, {TrueId, 1}};
+        std::vector<BDD_ID> pending{checked(f)};
+        while (!pending.empty()) {
+            const BDD_ID current = pending.back();
+            if (bounds.count(current)) {
+                pending.pop_back();
+                continue;
+            }
+            const uTableRow &n = node(current);
+            const auto high = bounds.find(n.high), low = bounds.find(n.low);
+            if (high == bounds.end() || low == bounds.end()) {
+                if (high == bounds.end()) {
+                    pending.push_back(n.high);
+                }
+                if (low == bounds.end()) {
+                    pending.push_back(n.low);
+                }
+                continue;
+            }
+            pending.pop_back();
+            bounds.emplace(current, std::min(cap, 1 + high->second + low->second));
+        }
+
+        std::unordered_map<BDD_ID, double> memo;
+        return heavy_branch_rec(f, threshold, memo, bounds);
+    }
+
+    // Bounded node count
+    size_t Manager::node_count_upto(const BDD_ID f, const size_t limit) {
+        std::unordered_set<BDD_ID> seen;
+        std::vector<BDD_ID> pending{f};
+        while (!pending.empty() && seen.size() <= limit) {
+            const BDD_ID current = pending.back();
+            pending.pop_back();
+            if (seen.insert(current).second && !isConstant(current)) {
+                pending.push_back(node(current).high);
+                pending.push_back(node(current).low);
+            }
+        }
+        return seen.size();
+    }
+
+    BDD_ID Manager::heavy_branch_rec(const BDD_ID f, const size_t threshold, std::unordered_map<BDD_ID, double> &memo,
+                                     const std::unordered_map<BDD_ID, size_t> &bounds) {
+        // The bound settles most nodes, only subgraphs with sharing are counted
+        if (bounds.at(f) <= threshold || node_count_upto(f, threshold) <= threshold) {
+            return f;
+        }
+        if (isConstant(f) || threshold < 3) {
+            return False();
+        }
+        const uTableRow n = node(f);
+        const bool high_heavy = density(n.high, memo) >= density(n.low, memo);
+        const BDD_ID heavy = high_heavy ? n.high : n.low;
+        const BDD_ID light = high_heavy ? n.low : n.high;
+        auto join = [&](const BDD_ID h, const BDD_ID l) {
+            return high_heavy ? make_node(n.topVar, h, l) : make_node(n.topVar, l, h);
+        };
+
+        // Subset the heavy branch, leaving room for this node. Every non-constant subset already contains
+        // the False terminal. The light branch gets what remains, the terminals are shared.
+        const BDD_ID kept = heavy_branch_rec(heavy, threshold - 1, memo, bounds);
+        const BDD_ID base_result = join(kept, False());
+        const size_t used = node_count_upto(base_result, threshold);
+        if (used >= threshold) {
+            return base_result;
+        }
+        const BDD_ID result = join(kept, heavy_branch_rec(light, threshold - used + 2, memo, bounds));
+        return node_count_upto(result, threshold) <= threshold ? result : base_result;
+    }
+
+    // Short path subsetting
+    BDD_ID Manager::shortPathSubset(const BDD_ID f, const size_t threshold) {
+        checked(f);
+        if (nodeCount(f) <= threshold) {
+            return f;
+        }
+
+        // Fewest decisions from each node to True
+        constexpr size_t unreachable = std::numeric_limits<size_t>::max();
+        std::unordered_map<BDD_ID, size_t> shortest{{FalseId, unreachable}, {TrueId, 0}};
+        std::vector<BDD_ID> pending{f};
+        while (!pending.empty()) {
+            const BDD_ID current = pending.back();
+            const uTableRow n = node(current);
+            const auto high = shortest.find(n.high);
+            const auto low = shortest.find(n.low);
+            if (high == shortest.end() || low == shortest.end()) {
+                if (high == shortest.end()) {
+                    pending.push_back(n.high);
+                }
+                if (low == shortest.end()) {
+                    pending.push_back(n.low);
+                }
+                continue;
+            }
+            pending.pop_back();
+            const size_t length = std::min(high->second, low->second);
+            shortest.emplace(current, length == unreachable ? unreachable : length + 1);
+        }
+        if (shortest.at(f) == unreachable) {
+            return False();
+        }
+
+        // Paths of g to True with at most depth decisions
+        std::unordered_map<uTableRow, BDD_ID, uTableRowHash> memo;
+        std::function<BDD_ID(BDD_ID, size_t)> paths_within = [&](const BDD_ID g, const size_t depth) -> BDD_ID {
+            if (g == True()) {
+                return True();
+            }
+            if (shortest.at(g) > depth) {
+                return False();
+            }
+            const uTableRow key(g, depth, 0);
+            const auto known = memo.find(key);
+            if (known != memo.end()) {
+                return known->second;
+            }
+            const uTableRow n = node(g);
+            const BDD_ID result = make_node(n.topVar, paths_within(n.high, depth - 1), paths_within(n.low, depth - 1));
+            memo.emplace(key, result);
+            return result;
+        };
+
+        BDD_ID result = False();
+        for (size_t depth = shortest.at(f); ; ++depth) {
+            const BDD_ID candidate = paths_within(f, depth);
+            if (nodeCount(candidate) > threshold) {
+                break;
+            }
+            result = candidate;
+            if (candidate == f) {
+                break;
+            }
+        }
+        if (result != False()) {
+            return result;
+        }
+
+        // Not even all shortest paths fit, keep a single one
+        std::vector<uTableRow> path;
+        for (BDD_ID g = f; g != True();) {
+            const uTableRow n = node(g);
+            path.push_back(n);
+            g = shortest.at(n.high) <= shortest.at(n.low) ? n.high : n.low;
+        }
+        BDD_ID cube = True();
+        for (auto step = path.rbegin(); step != path.rend(); ++step) {
+            cube = (shortest.at(step->high) <= shortest.at(step->low)) ? make_node(step->topVar, cube, False())
+                                                                       : make_node(step->topVar, False(), cube);
+        }
+        return nodeCount(cube) <= threshold ? cube : False();
+    }
+
+    // Remap under-approximation
+    BDD_ID Manager::remapUnderApprox(const BDD_ID f, const size_t threshold) {
+        BDD_ID g = checked(f);
+        std::unordered_map<BDD_ID, double> densities;
+        for (;;) {
+            std::set<BDD_ID> nodes;
+            findNodes(g, nodes);
+            if (nodes.size() <= threshold) {
+                return g;
+            }
+            if (isConstant(g) || threshold < 3) {
+                return False();
+            }
+
+            // Parents have smaller top variables than their children, so ordering by top variable
+            // visits every node after all of its parents
+            std::vector<BDD_ID> order;
+            for (const BDD_ID id : nodes) {
+                if (!isConstant(id)) {
+                    order.push_back(id);
+                }
+            }
+            std::sort(order.begin(), order.end(), [&](const BDD_ID l, const BDD_ID r) {
+                return node(l).topVar < node(r).topVar;
+            });
+
+            // Probability of reaching each node from the root, and the number of parents inside g
+            std::unordered_map<BDD_ID, double> reach{{g, 1.0}};
+            std::unordered_map<BDD_ID, size_t> parents;
+            for (const BDD_ID id : order) {
+                const uTableRow n = node(id);
+                reach[n.high] += reach[id] / 2;
+                reach[n.low] += reach[id] / 2;
+                parents[n.high]++;
+                parents[n.low]++;
+            }
+
+            // Nodes only reachable through a node are removed with it
+            std::unordered_map<BDD_ID, size_t> owned;
+            auto owned_by = [&](const BDD_ID child) -> size_t {
+                return !isConstant(child) && parents[child] == 1 ? owned[child] : 0;
+            };
+            for (auto id = order.rbegin(); id != order.rend(); ++id) {
+                const uTableRow n = node(*id);
+                owned[*id] = 1 + owned_by(n.high) + owned_by(n.low);
+            }
+
+            // Rate every inner node by lost minterms per saved node
+            struct Candidate {
+                BDD_ID id;
+                BDD_ID replacement;
+                double cost;
+                size_t saved;
+            };
+            std::vector<Candidate> candidates;
+            for (const BDD_ID id : order) {
+                if (id == g) {
+                    continue;
+                }
+                const uTableRow n = node(id);
+                BDD_ID replacement = False();
+                size_t saved = owned[id];
+                if (ite_rec(n.low, n.high, True()) == True()) {
+                    replacement = n.low;
+                    saved -= owned_by(n.low);
+                } else if (ite_rec(n.high, n.low, True()) == True()) {
+                    replacement = n.high;
+                    saved -= owned_by(n.high);
+                }
+                const double lost = reach[id] * (density(id, densities) - density(replacement, densities));
+                candidates.push_back(Candidate{id, replacement, lost / static_cast<double>(saved), saved});
+            }
+            std::sort(candidates.begin(), candidates.end(), [](const Candidate &l, const Candidate &r) {
+                return l.cost < r.cost;
+            });
+
+            std::unordered_map<BDD_ID, BDD_ID> remap;
+            size_t excess = nodes.size() - threshold;
+            for (const Candidate &candidate : candidates) {
+                remap.emplace(candidate.id, candidate.replacement);
+                if (candidate.saved >= excess) {
+                    break;
+                }
+                excess -= candidate.saved;
+            }
+
+            // Rebuild g with the remapped nodes
+            std::unordered_map<BDD_ID, BDD_ID> rebuilt{{FalseId, FalseId}, {TrueId, TrueId}};
+            std::function<BDD_ID(BDD_ID)> rebuild = [&](BDD_ID id) -> BDD_ID {
+                const auto done = rebuilt.find(id);
+                if (done != rebuilt.end()) {
+                    return done->second;
+                }
+                const auto mapped = remap.find(id);
+                const uTableRow n = node(id);
+                const BDD_ID result = mapped != remap.end() ? rebuild(mapped->second)
+                                                            : make_node(n.topVar, rebuild(n.high), rebuild(n.low));
+                rebuilt.emplace(id, result);
+                return result;
+            };
+            const BDD_ID next = rebuild(g);
+            if (nodeCount(next) >= nodes.size()) {
+                // No progress from remapping, fall back to dropping light branches
+                return heavyBranchSubset(next, threshold);
+            }
+            g = next;
+        }
+    }
+
+    // Under-approximation with the selected heuristic
+    BDD_ID Manager::underApprox(const BDD_ID f, const size_t threshold, const ApproxMethod method) {
+        switch (method) {
+            case ApproxMethod::ShortPath:
+                return shortPathSubset(f, threshold);
+            case ApproxMethod::Remap:
+                return remapUnderApprox(f, threshold);
+            default:
+                return heavyBranchSubset(f, threshold);
+        }
+    }
+
+    // Over-approximation as the complement of an under-approximation of the complement
+    BDD_ID Manager::overApprox(const BDD_ID f, const size_t threshold, const ApproxMethod method) {
+        return neg(underApprox(neg(f), threshold, method));
+    }
+
+    // Snapshot of the performance counters
+    ManagerStats Manager::stats() const {
+#ifdef VDS_MANAGER_STATS
+        ManagerStats snapshot = counters;
+        snapshot.enabled = true;
+        return snapshot;
+#else
+        return ManagerStats{};
+#endif
     }
 
     // Visualize the BDD
@@ -352,7 +1298,7 @@ namespace ClassProject {
         for (const auto& node : nodes_of_root)
         {
             // take node from table
-            const auto &nodeData = unique_tb.at(node);
+            const auto &nodeData = this->node(node);
 
             //create Node in DOT-format
             if (vars_of_root.find(node) != vars_of_root.end()) {
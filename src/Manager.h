@@ -11,13 +11,34 @@
 #include <fstream>
 #include <iomanip>
 #include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <memory>
+
+// Increment a Manager performance counter. Expands to nothing unless the build enables VDS_MANAGER_STATS.
+#ifdef VDS_MANAGER_STATS
+#define VDS_STAT(stmt) do { stmt; } while (false)
+#else
+#define VDS_STAT(stmt) do { } while (false)
+#endif
 
+// Internal node accesses are bounds checked in Debug builds (NDEBUG unset) or when the build defines
+// VDS_MANAGER_SAFE_MODE. Otherwise they index the node store directly.
+#if defined(VDS_MANAGER_SAFE_MODE) || !defined(NDEBUG)
+#define VDS_MANAGER_CHECKED 1
+#else
+#define VDS_MANAGER_CHECKED 0
+#endif
 
 namespace ClassProject {
 
     // Constants for False and True BDD nodes
     static constexpr BDD_ID FalseId = 0;
     static constexpr BDD_ID TrueId = 1;
+    // Marks reclaimed unique table slots and failed operations
+    static constexpr BDD_ID InvalidId = std::numeric_limits<BDD_ID>::max();
 
     // Structure representing a unique table row
     struct uTableRow {
@@ -49,25 +70,189 @@ namespace ClassProject {
         }
     };
 
+    // Evaluation order of an ite based operation
+    enum class ApplyMode {
+        DepthFirst,   // recursive Shannon expansion (default)
+        BreadthFirst  // level by level expansion and reduction, for operands larger than the cache
+    };
+
+    // Subsetting heuristic of an approximation, see Manager::underApprox()
+    enum class ApproxMethod {
+        HeavyBranch, // keep the branch with more minterms, drop the lighter one
+        ShortPath,   // keep the paths to True with the fewest decisions
+        Remap        // replace nodes by a child or False where few minterms are lost per saved node
+    };
+
+    // High-water mark of a Manager, see Manager::checkpoint()
+    struct Checkpoint {
+        size_t nodes;      // unique table slots at the time of the checkpoint
+        size_t labels;     // interned labels at the time of the checkpoint
+        size_t depth;      // position on the checkpoint stack
+        size_t log;        // computed table log length at the time of the checkpoint
+    };
+
+    // Read-only layer of the node store shared by a Manager and its forks, see Manager::fork(). Every
+    // freeze stacks a new layer on the previous one instead of copying it.
+    struct FrozenStore {
+        std::shared_ptr<const FrozenStore> parent;                     // layer below, nullptr for the first
+        BDD_ID first = 0;                                              // ID of nodes[0]
+        size_t depth = 1;                                              // number of layers down to the first
+        std::vector<uTableRow> nodes;                                  // nodes first .. first + nodes.size() - 1
+        std::unordered_map<uTableRow, BDD_ID, uTableRowHash> unique;   // reverse unique table of this layer
+        std::unordered_map<uTableRow, BDD_ID, uTableRowHash> computed; // computed table of this layer
+        size_t freed = 0;                                              // reclaimed slots in this and all lower layers
+    };
+
+    // Snapshot of the Manager performance counters, see Manager::stats()
+    struct ManagerStats {
+        bool enabled = false;              // false if the build was configured without VDS_MANAGER_STATS
+
+        uint64_t iteCalls = 0;             // every invocation of ite, including recursive ones
+        uint64_t iteTerminalHits = 0;      // ite calls answered by a terminal case
+        uint64_t iteCanonicalized = 0;     // ite triples rewritten by standard_triples before the table lookup
+
+        uint64_t computedLookups = 0;
+        uint64_t computedHits = 0;
+        uint64_t computedMisses = 0;
+        uint64_t computedEvictions = 0;    // entries dropped from the computed table
+
+        uint64_t uniqueLookups = 0;
+        uint64_t uniqueInserts = 0;
+        uint64_t uniqueProbeLength = 0;    // sum of bucket lengths over all unique table lookups
+        uint64_t uniqueMaxProbeLength = 0;
+
+        uint64_t peakNodes = 0;            // largest unique table size seen so far
+    };
+
     // Manager class for BDD operations
+    //
+    // Every ManagerInterface method is overridden as final, so calls through a Manager (or a class derived
+    // from it, like Reachability) bind statically and the hot accessors defined in this header are inlined.
+    // ManagerInterface remains the thin virtual adapter for code that only knows the interface.
     class Manager : public ManagerInterface {
     private:
-        std::unordered_map<BDD_ID, uTableRow> unique_tb; // Unique table
+        // Frozen base shared with forks. Nodes below base_size live in the base, the tables below
+        // only hold the private overlay on top of it. Without forks the base is empty, base_size is 0
+        // and all accesses take the direct path.
+        std::shared_ptr<const FrozenStore> base;
+        BDD_ID base_size = 0;
+
+        std::vector<uTableRow> unique_tb; // Unique table, indexed by BDD_ID - base_size
         std::unordered_map<uTableRow, BDD_ID, uTableRowHash> rev_uniq_tb; // Reverse unique table
         std::unordered_map<uTableRow, BDD_ID, uTableRowHash> computed_tb; // Computed table
 
+        // Interned variable labels: all labels live in one buffer, label i spans
+        // [label_offsets[i], label_offsets[i + 1])
+        std::string label_pool;
+        std::vector<size_t> label_offsets{0};
+        std::unordered_map<BDD_ID, size_t> var_label; // Variable ID -> label index
+
+        std::vector<uint32_t> ref_counts; // References held by BDD handles, grown on demand
+        std::vector<BDD_ID> free_ids;     // Slots reclaimed by garbageCollect, reused for new nodes
+
+        std::vector<Checkpoint> checkpoints; // Open checkpoints, innermost last
+        std::vector<uTableRow> computed_log; // Computed table keys inserted while a checkpoint is open
+
+        // Node creation beyond this ID aborts the running operation, see andLimit()
+        BDD_ID node_limit = InvalidId;
+        struct NodeLimitExceeded {};
+
+#ifdef VDS_MANAGER_STATS
+        ManagerStats counters; // Performance counters
+
+        // Record the bucket length probed by a unique table lookup
+        void count_unique_probe(const uTableRow& row);
+#endif
+
         // Print the unique table
         void print_unique_tb();
 
         // Initialize the unique table
         void init_unique_tb();
 
-        // Get the next available BDD ID
-        BDD_ID get_nextID()
+        // Get the next BDD ID at the end of the unique table
+        BDD_ID get_nextID() const
+        {
+            return base_size + unique_tb.size();
+        }
+
+        // Validate a user supplied ID once at the API boundary
+        BDD_ID checked(const BDD_ID f) const
+        {
+            if (!isValidId(f)) {
+                throw std::out_of_range("Unknown BDD_ID " + std::to_string(f));
+            }
+            return f;
+        }
+
+        // Internal node access: bounds checked in safe mode, raw indexing otherwise
+        const uTableRow &node(const BDD_ID f) const
+        {
+#if VDS_MANAGER_CHECKED
+            return f >= base_size ? unique_tb.at(f - base_size) : frozen_node(f);
+#else
+            if (base_size == 0) {
+                return unique_tb[f]; // never forked
+            }
+            return f >= base_size ? unique_tb[f - base_size] : frozen_node(f);
+#endif
+        }
+
+        // Lookups in the frozen layers, only reached by forked managers
+        const uTableRow &frozen_node(BDD_ID f) const;
+        BDD_ID frozen_unique(const uTableRow &row) const;
+        BDD_ID frozen_result(const uTableRow &key) const;
+
+        // Return the node (x, high, low), creating it if it is not in the unique table yet
+        BDD_ID find_or_add(BDD_ID x, BDD_ID high, BDD_ID low);
+
+        // Look up a computed table entry in the overlay and the frozen base, InvalidId if absent
+        BDD_ID find_result(const uTableRow &key) const
         {
-            return uniqueTableSize();
+            const auto entry = computed_tb.find(key);
+            if (entry != computed_tb.end()) {
+                return entry->second;
+            }
+            return base ? frozen_result(key) : InvalidId;
         }
 
+        // Move the current state into a new frozen layer on top of the base, leaving an empty overlay
+        void freeze();
+
+        // Insert a computed table entry, logging it while a checkpoint is open
+        void cache_result(const uTableRow &key, BDD_ID result)
+        {
+            if (computed_tb.emplace(key, result).second && !checkpoints.empty()) {
+                computed_log.push_back(key);
+            }
+        }
+
+        // Unchecked recursive cores of the public operations
+        BDD_ID ite_rec(BDD_ID i, BDD_ID t, BDD_ID e);
+        BDD_ID co_factor_true_rec(BDD_ID f, BDD_ID x);
+        BDD_ID co_factor_false_rec(BDD_ID f, BDD_ID x);
+        BDD_ID ite_breadth_first(BDD_ID i, BDD_ID t, BDD_ID e);
+
+        // Approximation helpers
+        double density(BDD_ID f, std::unordered_map<BDD_ID, double> &memo);
+        BDD_ID make_node(BDD_ID x, BDD_ID high, BDD_ID low);
+        BDD_ID restrict_rec(BDD_ID f, BDD_ID c, std::unordered_map<uTableRow, BDD_ID, uTableRowHash> &memo);
+
+        // Quantification helpers, memo keys are (f, g, cube) and (f, cube, 0)
+        bool intersects_rec(BDD_ID f, BDD_ID g, std::unordered_set<uTableRow, uTableRowHash> &disjoint);
+        BDD_ID compose_rec(BDD_ID f, const std::unordered_map<BDD_ID, BDD_ID> &substitution,
+                           std::unordered_map<BDD_ID, BDD_ID> &memo);
+        BDD_ID exists_rec(BDD_ID f, BDD_ID cube, std::unordered_map<uTableRow, BDD_ID, uTableRowHash> &memo);
+        BDD_ID and_exists_rec(BDD_ID f, BDD_ID g, BDD_ID cube,
+                              std::unordered_map<uTableRow, BDD_ID, uTableRowHash> &memo,
+                              std::unordered_map<uTableRow, BDD_ID, uTableRowHash> &exists_memo);
+        // Heavy branch subsetting. bounds holds an upper bound of the size of every subgraph of the input,
+        // computed once, so only subgraphs that may not fit are counted (up to the threshold).
+        BDD_ID heavy_branch_rec(BDD_ID f, size_t threshold, std::unordered_map<BDD_ID, double> &memo,
+                                const std::unordered_map<BDD_ID, size_t> &bounds);
+        // Nodes reachable from f (as nodeCount), the traversal stops once more than limit are found
+        size_t node_count_upto(BDD_ID f, size_t limit);
+
     public:
 
         // Constructor
@@ -77,23 +262,29 @@ namespace ClassProject {
         ~Manager() = default;
 
         // Create a new variable
-        BDD_ID createVar(const std::string &label) override;
+        BDD_ID createVar(const std::string &label) final;
 
         // Return the BDD ID for True
-        const BDD_ID &True() override;
+        const BDD_ID &True() final
+        {
+            return TrueId;
+        }
 
         // Return the BDD ID for False
-        const BDD_ID &False() override;
+        const BDD_ID &False() final
+        {
+            return FalseId;
+        }
 
-        // Get the unique table
-        std::unordered_map<BDD_ID, uTableRow> getUniqueTable()
+        // Get the unique table (only the private overlay after fork(), IDs start at the frozen base size)
+        const std::vector<uTableRow> &getUniqueTable() const
         {
             return unique_tb;
         }
 
         // Check if the computed table contains a specific row
         bool computedTableContains(const uTableRow& row) const {
-            return computed_tb.find(row) != computed_tb.end();
+            return find_result(row) != InvalidId;
         }
 
         /**
@@ -101,7 +292,10 @@ namespace ClassProject {
         * @param f ID of the Node under test
         * @return true if f is a constant 0 or 1
         */
-        bool isConstant(BDD_ID f) override;
+        bool isConstant(const BDD_ID f) final
+        {
+            return f == TrueId || f == FalseId;
+        }
 
         /**
         * isVariable determines if a node is a variable
@@ -109,71 +303,277 @@ namespace ClassProject {
         * @return returns true if id of x is equal to topVar of x and x is not a leafnode
         * see /doc/VDSCP_Part_1.pdf Tab. 2 for a better understanding
         */
-        bool isVariable(BDD_ID x) override;
+        bool isVariable(const BDD_ID x) final
+        {
+            return node(checked(x)).topVar == x && !isConstant(x);
+        }
 
         /**
         * topVar returns the top Variable of the node
         * @param f ID of the Node under test
         * @return topVar of f
         */
-        BDD_ID topVar(BDD_ID f) override;
+        BDD_ID topVar(const BDD_ID f) final
+        {
+            return node(checked(f)).topVar;
+        }
 
         // ITE (if-then-else) operation
-        BDD_ID ite(BDD_ID i, BDD_ID t, BDD_ID e) override;
+        BDD_ID ite(BDD_ID i, BDD_ID t, BDD_ID e) final;
+
+        /**
+        * ite with a selectable evaluation order
+        * @param mode BreadthFirst expands all requests of one variable level before the next level
+        * and builds the result bottom-up level by level, so node accesses and insertions are
+        * sequential per level instead of following the recursion (CAL style apply)
+        * @return the same node as ite(i, t, e)
+        */
+        BDD_ID ite(BDD_ID i, BDD_ID t, BDD_ID e, ApplyMode mode);
 
         // Compute the cofactor of a node with respect to a variable (true branch)
-        BDD_ID coFactorTrue(BDD_ID f, BDD_ID x) override;
+        BDD_ID coFactorTrue(BDD_ID f, BDD_ID x) final;
 
         // Compute the cofactor of a node with respect to a variable (false branch)
-        BDD_ID coFactorFalse(BDD_ID f, BDD_ID x) override;
+        BDD_ID coFactorFalse(BDD_ID f, BDD_ID x) final;
 
         // Compute the cofactor of a node (true branch)
-        BDD_ID coFactorTrue(BDD_ID f) override;
+        BDD_ID coFactorTrue(const BDD_ID f) final
+        {
+            return node(checked(f)).high;
+        }
 
         // Compute the cofactor of a node (false branch)
-        BDD_ID coFactorFalse(BDD_ID f) override;
+        BDD_ID coFactorFalse(const BDD_ID f) final
+        {
+            return node(checked(f)).low;
+        }
+
+        /**
+        * restrict simplifies f with the care set c (Coudert/Madre generalized cofactor): the result
+        * agrees with f wherever c holds and is chosen freely elsewhere, usually with fewer nodes
+        * @return g with g & c == f & c, f itself if c is True or False
+        */
+        BDD_ID restrict(BDD_ID f, BDD_ID c);
+
+        /**
+        * exists quantifies the variables of cube out of f
+        * @param cube conjunction of the (positive) variables to quantify
+        * @return f with every variable of cube existentially quantified
+        */
+        BDD_ID exists(BDD_ID f, BDD_ID cube);
+
+        /**
+        * andExists computes exists(f & g, cube) without building the conjunction first (relational product).
+        * Variables are quantified as soon as the recursion passes them, so the intermediate result stays
+        * small, which is the core of image computation.
+        * @param cube conjunction of the (positive) variables to quantify
+        */
+        BDD_ID andExists(BDD_ID f, BDD_ID g, BDD_ID cube);
+
+        /**
+        * intersects checks whether f & g is satisfiable without building the conjunction. The recursion
+        * stops at the first common path to True and creates no nodes.
+        * @return true if f & g != False
+        */
+        bool intersects(BDD_ID f, BDD_ID g);
+
+        /**
+        * vectorCompose substitutes functions for variables of f, all at the same time
+        * @param substitution maps variables to the functions replacing them, other variables are kept
+        * @return f with every mapped variable x replaced by substitution[x]
+        */
+        BDD_ID vectorCompose(BDD_ID f, const std::unordered_map<BDD_ID, BDD_ID> &substitution);
+
+        /**
+        * cube builds a conjunction of literals bottom-up, one unique table lookup per variable and no ite calls
+        * @param vars variables of the cube, in any order and each at most once
+        * @param values polarity of every variable (false means negated), all positive if empty
+        * @return the cube, True if vars is empty
+        */
+        BDD_ID cube(const std::vector<BDD_ID> &vars, const std::vector<bool> &values = {});
 
         // Swap two BDD IDs
         static void swapID(BDD_ID& a, BDD_ID& b);
 
-        // Apply standard triples simplifications
+        // Rewrite an ite triple into its canonical form, applied before every computed table lookup
         void standard_triples(BDD_ID& i, BDD_ID& t, BDD_ID& e);
 
         // AND operation
-        BDD_ID and2(BDD_ID a, BDD_ID b) override;
+        BDD_ID and2(BDD_ID a, BDD_ID b) final;
+
+        // AND operation with a selectable evaluation order
+        BDD_ID and2(BDD_ID a, BDD_ID b, ApplyMode mode);
+
+        /**
+        * andLimit conjoins a and b unless that needs more than limit new nodes. An aborted conjunction
+        * is rolled back completely, so the manager stays usable and contains no partial result.
+        * @return a & b, or InvalidId if the result would need more than limit new nodes
+        */
+        BDD_ID andLimit(BDD_ID a, BDD_ID b, size_t limit);
+
+        /**
+        * andLimit with a selectable evaluation order. The breadth-first engine creates its nodes only in the
+        * reduction phase, so an aborted conjunction has still expanded all of its requests.
+        * @return a & b, or InvalidId if the result would need more than limit new nodes
+        */
+        BDD_ID andLimit(BDD_ID a, BDD_ID b, size_t limit, ApplyMode mode);
 
         // OR operation
-        BDD_ID or2(BDD_ID a, BDD_ID b) override;
+        BDD_ID or2(BDD_ID a, BDD_ID b) final;
+
+        // OR operation with a selectable evaluation order
+        BDD_ID or2(BDD_ID a, BDD_ID b, ApplyMode mode);
 
         // XOR operation
-        BDD_ID xor2(BDD_ID a, BDD_ID b) override;
+        BDD_ID xor2(BDD_ID a, BDD_ID b) final;
 
         // Negation operation
-        BDD_ID neg(BDD_ID a) override;
+        BDD_ID neg(BDD_ID a) final;
 
         // NAND operation
-        BDD_ID nand2(BDD_ID a, BDD_ID b) override;
+        BDD_ID nand2(BDD_ID a, BDD_ID b) final;
 
         // NOR operation
-        BDD_ID nor2(BDD_ID a, BDD_ID b) override;
+        BDD_ID nor2(BDD_ID a, BDD_ID b) final;
 
         // XNOR operation
-        BDD_ID xnor2(BDD_ID a, BDD_ID b) override;
+        BDD_ID xnor2(BDD_ID a, BDD_ID b) final;
 
-        // Get the name of the top variable of a node
-        std::string getTopVarName(const BDD_ID &root) override;
+        /**
+        * getTopVarName returns the label of the top variable of a node
+        * @param root ID of the Node under test
+        * @return "True"/"False" for the leaf nodes, otherwise the label passed to createVar.
+        * The view points into the label table and stays valid until the next createVar call.
+        */
+        std::string_view getTopVarName(const BDD_ID &root) final;
 
         // Find all nodes reachable from a root node
-        void findNodes(const BDD_ID &root, std::set<BDD_ID> &nodes_of_root) override;
+        void findNodes(const BDD_ID &root, std::set<BDD_ID> &nodes_of_root) final;
 
         // Find all variables in the BDD rooted at a node
-        void findVars(const BDD_ID &root, std::set<BDD_ID> &vars_of_root) override;
+        void findVars(const BDD_ID &root, std::set<BDD_ID> &vars_of_root) final;
 
         // Get the size of the unique table
-        size_t uniqueTableSize() override;
+        size_t uniqueTableSize() final
+        {
+            return get_nextID() - free_ids.size() - (base ? base->freed : 0);
+        }
+
+        // Check if f names a live node of this manager
+        bool isValidId(const BDD_ID f) const
+        {
+            return f < get_nextID() && node(f).topVar != InvalidId;
+        }
+
+        // Register one more BDD handle holding f
+        void ref(BDD_ID f);
+
+        // Release one BDD handle holding f
+        void deref(BDD_ID f);
+
+        // Number of BDD handles currently holding f
+        size_t refCount(BDD_ID f) const
+        {
+            return f < ref_counts.size() ? ref_counts[f] : 0;
+        }
+
+        /**
+        * garbageCollect reclaims every node that is not reachable from a node held by a BDD handle.
+        * Terminals and variables are always kept. Raw BDD_IDs of reclaimed nodes become invalid
+        * and their slots are reused, so only call this when every live function is held by a handle.
+        * @return number of reclaimed nodes
+        */
+        size_t garbageCollect();
+
+        /**
+        * checkpoint records the current high-water mark of the node store. While a checkpoint is
+        * open, new nodes are always appended, so everything built afterwards can be dropped again.
+        * @return token for rollback or commit
+        */
+        Checkpoint checkpoint();
+
+        /**
+        * rollback removes every node, variable and computed table entry created since the checkpoint,
+        * in time proportional to the work done since then. The checkpoint and all checkpoints opened
+        * after it are closed. Raw IDs of removed nodes become invalid.
+        * @throws std::runtime_error if the token is not open or a BDD handle still holds a removed node
+        */
+        void rollback(const Checkpoint &token);
+
+        /**
+        * commit closes the checkpoint (and all checkpoints opened after it) and keeps all nodes
+        * @throws std::runtime_error if the token is not open
+        */
+        void commit(const Checkpoint &token);
+
+        /**
+        * fork creates an independent Manager for a what-if continuation. The current node store, unique
+        * and computed tables are frozen into a base that this manager and the fork share read-only, both
+        * keep their own overlay for new nodes. IDs and variable labels up to the fork stay valid in both.
+        * Frozen nodes are never reclaimed. Each manager may be used by one thread, concurrently with
+        * the other forks of the same base.
+        * @return the forked manager
+        * @throws std::runtime_error while a checkpoint is open
+        */
+        std::unique_ptr<Manager> fork();
+
+        /**
+        * transfer copies the function rooted at root from src into dst, bottom-up with memoization,
+        * so every node of the source DAG is rebuilt once
+        * @param varMap maps every variable in the support of root to a variable of dst. The variables
+        * may be ordered differently in dst, the function is then rebuilt with ite.
+        * @return ID of the same function in dst
+        * @throws std::out_of_range if root is unknown in src or a variable has no valid mapping in dst
+        */
+        static BDD_ID transfer(Manager &src, BDD_ID root, Manager &dst,
+                               const std::unordered_map<BDD_ID, BDD_ID> &varMap);
+
+        // Number of nodes in the frozen base shared with forks, 0 if this manager was never forked
+        size_t frozenSize() const
+        {
+            return base_size;
+        }
+
+        // Number of nodes reachable from f, including the terminals (same count as findNodes)
+        size_t nodeCount(BDD_ID f);
+
+        /**
+        * heavyBranchSubset returns a subset of f with at most threshold nodes. Starting at the root,
+        * the child with fewer minterms is dropped (replaced by False) until the remainder fits, the
+        * heavier child is subsetted recursively.
+        * @return g with g -> f and nodeCount(g) <= threshold (False if not even one path fits)
+        */
+        BDD_ID heavyBranchSubset(BDD_ID f, size_t threshold);
+
+        /**
+        * shortPathSubset keeps the paths from the root to True with the fewest decisions, raising the
+        * admitted path length as long as the result stays within threshold nodes
+        * @return g with g -> f and nodeCount(g) <= threshold (False if not even one path fits)
+        */
+        BDD_ID shortPathSubset(BDD_ID f, size_t threshold);
+
+        /**
+        * remapUnderApprox replaces inner nodes by one of their children (if it implies the other) or by
+        * False, choosing the nodes that lose the fewest minterms per saved node first
+        * @return g with g -> f and nodeCount(g) <= threshold (False if not even one path fits)
+        */
+        BDD_ID remapUnderApprox(BDD_ID f, size_t threshold);
+
+        // Under-approximation of f within threshold nodes, using the selected heuristic
+        BDD_ID underApprox(BDD_ID f, size_t threshold, ApproxMethod method = ApproxMethod::HeavyBranch);
+
+        // Over-approximation of f within threshold nodes: the complement of an under-approximation of !f
+        BDD_ID overApprox(BDD_ID f, size_t threshold, ApproxMethod method = ApproxMethod::HeavyBranch);
 
         // Visualize the BDD
-        void visualizeBDD(std::string filepath, BDD_ID &root) override;
+        void visualizeBDD(std::string filepath, BDD_ID &root) final;
+
+        /**
+        * stats returns a snapshot of the performance counters
+        * @return all counters, or a zeroed snapshot with enabled == false if the
+        * build was configured without VDS_MANAGER_STATS
+        */
+        ManagerStats stats() const;
     };
 }
 
@@ -6,6 +6,7 @@
 #define VDSPROJECT_MANAGERINTERFACE_H
 
 #include <string>
+#include <string_view>
 #include <set>
 
 namespace ClassProject {
@@ -14,6 +15,8 @@ namespace ClassProject {
 
     class ManagerInterface {
     public:
+        virtual ~ManagerInterface() = default;
+
         virtual BDD_ID createVar(const std::string &label) = 0;
 
         virtual const BDD_ID &True() = 0;
@@ -50,7 +53,7 @@ namespace ClassProject {
 
         virtual BDD_ID xnor2(BDD_ID a, BDD_ID b) = 0;
 
-        virtual std::string getTopVarName(const BDD_ID &root) = 0;
+        virtual std::string_view getTopVarName(const BDD_ID &root) = 0;
 
         virtual void findNodes(const BDD_ID &root, std::set<BDD_ID> &nodes_of_root) = 0;
 
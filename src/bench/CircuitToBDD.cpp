@@ -10,14 +10,14 @@
 #include "tqdm/tqdm.h"
 
 
-CircuitToBDD::CircuitToBDD(shared_ptr<ClassProject::ManagerInterface> BDD_manager_p) {
+CircuitToBDD::CircuitToBDD(shared_ptr<ClassProject::Manager> BDD_manager_p) {
     bdd_manager = std::move(BDD_manager_p);
 }
 
 CircuitToBDD::~CircuitToBDD() = default;
 
 void CircuitToBDD::GenerateBDD(const list_of_circuit_t &circuit, const std::string& benchmark_file) {
-    ClassProject::BDD_ID BDD_node;
+    ClassProject::BDD BDD_node;
 
     std::filesystem::path pathToBenchFile(benchmark_file);
     if (!pathToBenchFile.has_filename())
@@ -63,14 +63,14 @@ void CircuitToBDD::GenerateBDD(const list_of_circuit_t &circuit, const std::stri
         } else if (circuit_node.gate_type == XOR_GATE_T) {
             BDD_node = XorGate(circuit_node.input_id_list);
         } else if (circuit_node.gate_type == BUFFER_GATE_T) {
-            BDD_node = findBddId(*circuit_node.input_id_list.begin());
+            BDD_node = findBdd(*circuit_node.input_id_list.begin());
         }
 
         /* OUTPUT or FLIP FLOP gates do not generate a BDD */
         if (!((circuit_node.gate_type == OUTPUT_GATE_T) | (circuit_node.gate_type == FLIP_FLOP_GATE_T))) {
-            node_to_bdd_id.insert(std::pair<unique_ID_t, ClassProject::BDD_ID>(circuit_node.id, BDD_node));
-            label_to_bdd_id.insert(std::pair<label_t, ClassProject::BDD_ID>(circuit_node.label, BDD_node));
-            bdd_out_file << BDD_node << "," << circuit_node.label << std::endl;
+            node_to_bdd_id.emplace(circuit_node.id, BDD_node);
+            label_to_bdd_id.emplace(circuit_node.label, BDD_node);
+            bdd_out_file << BDD_node.id() << "," << circuit_node.label << std::endl;
         }
     }
 
@@ -78,142 +78,73 @@ void CircuitToBDD::GenerateBDD(const list_of_circuit_t &circuit, const std::stri
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::findBddId(unique_ID_t circuit_node) {
+const ClassProject::BDD &CircuitToBDD::findBdd(unique_ID_t circuit_node) {
 
-    auto bdd_id_it = node_to_bdd_id.find(circuit_node);
+    auto bdd_it = node_to_bdd_id.find(circuit_node);
 
-    if (bdd_id_it != node_to_bdd_id.end()) {
-        return bdd_id_it->second;
+    if (bdd_it != node_to_bdd_id.end()) {
+        return bdd_it->second;
     } else {
         throw std::runtime_error("Destination node ID is not part of the circuit graph!");
     }
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::InputGate(const label_t &label) {
-    return bdd_manager->createVar(label);
+ClassProject::BDD CircuitToBDD::InputGate(const label_t &label) {
+    return {*bdd_manager, bdd_manager->createVar(label)};
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::NotGate(const set_of_circuit_t &inputNodes) {
-    unique_ID_t node = *inputNodes.begin();
-    return bdd_manager->neg(findBddId(node));
+ClassProject::BDD CircuitToBDD::NotGate(const set_of_circuit_t &inputNodes) {
+    return ~findBdd(*inputNodes.begin());
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::AndGate(set_of_circuit_t inputNodes) {
+ClassProject::BDD CircuitToBDD::AndGate(const set_of_circuit_t &inputNodes) {
     auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
+    ClassProject::BDD result = findBdd(*it);
 
-    /* Get the ClassProject::BDD_ID of first elements */
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    while (!inputNodes.empty()) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
-
-        first_op = bdd_manager->and2(first_op, second_op);
+    while (++it != inputNodes.end()) {
+        result &= findBdd(*it);
     }
 
-    /* Return the ClassProject::BDD_ID equivalent to the AND of all inputs */
-    return first_op;
+    /* Return the BDD equivalent to the AND of all inputs */
+    return result;
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::OrGate(set_of_circuit_t inputNodes) {
+ClassProject::BDD CircuitToBDD::OrGate(const set_of_circuit_t &inputNodes) {
     auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
-
-    /* Get the ClassProject::BDD_ID of first elements */
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
+    ClassProject::BDD result = findBdd(*it);
 
-    while (!inputNodes.empty()) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
-
-        first_op = bdd_manager->or2(first_op, second_op);
+    while (++it != inputNodes.end()) {
+        result |= findBdd(*it);
     }
 
-    /* Return the ClassProject::BDD_ID equivalent to the OR of all inputs */
-    return first_op;
+    /* Return the BDD equivalent to the OR of all inputs */
+    return result;
 }
 
-ClassProject::BDD_ID CircuitToBDD::NandGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
-
-    /* Get the ClassProject::BDD_ID of first elements */
-    it = inputNodes.begin();
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    if (inputNodes.size() == 1) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
-
-        /* Create the NAND BDD node for the first two elements */
-        first_op = bdd_manager->nand2(first_op, second_op);
-    } else {
-        /* AND of all inputs, to use as the second operator of the NAND gate */
-        second_op = AndGate(inputNodes);
-        /* Create the NAND BDD node */
-        first_op = bdd_manager->nand2(first_op, second_op);
-    }
-
-    /* Return the ClassProject::BDD_ID equivalent to the NAND of all inputs */
-    return first_op;
+ClassProject::BDD CircuitToBDD::NandGate(const set_of_circuit_t &inputNodes) {
+    /* Return the BDD equivalent to the NAND of all inputs */
+    return ~AndGate(inputNodes);
 }
 
-ClassProject::BDD_ID CircuitToBDD::NorGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
-
-    /* Get the ClassProject::BDD_ID of first elements */
-    it = inputNodes.begin();
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    if (inputNodes.size() == 1) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
-
-        /* Create the NOR BDD node for the first two elements */
-        first_op = bdd_manager->nor2(first_op, second_op);
-    } else {
-        /* OR of all inputs, to use as the second operator of the NAND gate */
-        second_op = OrGate(inputNodes);
-        /* Create the NOR BDD node */
-        first_op = bdd_manager->nor2(first_op, second_op);
-    }
-
-    /* Return the ClassProject::BDD_ID equivalent to the NOR of all inputs */
-    return first_op;
+ClassProject::BDD CircuitToBDD::NorGate(const set_of_circuit_t &inputNodes) {
+    /* Return the BDD equivalent to the NOR of all inputs */
+    return ~OrGate(inputNodes);
 }
 
-ClassProject::BDD_ID CircuitToBDD::XorGate(set_of_circuit_t inputNodes) {
+ClassProject::BDD CircuitToBDD::XorGate(const set_of_circuit_t &inputNodes) {
     auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
-
-    /* Get the ClassProject::BDD_ID of first elements */
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    while (!inputNodes.empty()) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
+    ClassProject::BDD result = findBdd(*it);
 
-        first_op = bdd_manager->xor2(first_op, second_op);
+    while (++it != inputNodes.end()) {
+        result ^= findBdd(*it);
     }
 
-    /* Return the ClassProject::BDD_ID equivalent to the XOR of all inputs */
-    return first_op;
+    /* Return the BDD equivalent to the XOR of all inputs */
+    return result;
 }
 
 void CircuitToBDD::PrintBDD(const std::set<label_t> &output_labels) {
@@ -243,8 +174,8 @@ void CircuitToBDD::PrintBDD(const std::set<label_t> &output_labels) {
 
             output_nodes.clear();
             output_vars.clear();
-            bdd_manager->findNodes(output_id_it->second, output_nodes);
-            bdd_manager->findVars(output_id_it->second, output_vars);
+            bdd_manager->findNodes(output_id_it->second.id(), output_nodes);
+            bdd_manager->findVars(output_id_it->second.id(), output_vars);
 
             dumpBddText(bdd_out_txt_file);
             dumpBddDot(bdd_out_dot_file);
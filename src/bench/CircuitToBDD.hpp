@@ -6,7 +6,7 @@
 #pragma once
 
 #include "BenchParser.hpp"
-#include "../ManagerInterface.h"
+#include "../BDD.h"
 #include <iostream>
 #include <fstream>
 #include <filesystem>
@@ -26,7 +26,11 @@ class CircuitToBDD {
 
 public:
 
-    explicit CircuitToBDD(shared_ptr<ClassProject::ManagerInterface> BDD_manager_p);
+    /**
+     * \brief Binds the converter to a BDD manager
+     * \param BDD_manager_p the concrete Manager, so all gate calls bind statically and can be inlined
+     */
+    explicit CircuitToBDD(shared_ptr<ClassProject::Manager> BDD_manager_p);
     ~CircuitToBDD();
 
     /**
@@ -49,10 +53,10 @@ public:
 
 private:
 
-    std::unordered_map<unique_ID_t, ClassProject::BDD_ID> node_to_bdd_id; ///< Mapping from circuit node's unique ID to its BDD ID
-    std::unordered_map<label_t, ClassProject::BDD_ID> label_to_bdd_id; ///< Mapping from node's label to its BDD ID
+    shared_ptr<ClassProject::Manager> bdd_manager{}; ///< Declared first, so it outlives the handles below
 
-    shared_ptr<ClassProject::ManagerInterface> bdd_manager{};
+    std::unordered_map<unique_ID_t, ClassProject::BDD> node_to_bdd_id; ///< Mapping from circuit node's unique ID to its BDD
+    std::unordered_map<label_t, ClassProject::BDD> label_to_bdd_id; ///< Mapping from node's label to its BDD
     std::string result_dir; ///< Directory where the results are stored
 
     std::set<ClassProject::BDD_ID> output_nodes;
@@ -60,68 +64,68 @@ private:
 
 
     /**
-     * \brief Returns the BDD_ID of the given circuit ID
+     * \brief Returns the BDD of the given circuit ID
      * \param circuit_node is unique_ID_t
-     * \return ClassProject::BDD_ID
+     * \return ClassProject::BDD
      *
      */
-    ClassProject::BDD_ID findBddId(unique_ID_t circuit_node);
+    const ClassProject::BDD &findBdd(unique_ID_t circuit_node);
 
     /**
      * \brief Generates the BDD node equivalent to a variable with label "label".
      * \param label is label_t
-     * \return ClassProject::BDD_ID
+     * \return ClassProject::BDD
      *
      */
-    ClassProject::BDD_ID InputGate(const label_t &label);
+    ClassProject::BDD InputGate(const label_t &label);
 
     /**
      * \brief Generates the BDD node equivalent to the NOT gate.
      * \param node is set_of_circuit_t containing the circuit ID of the gate to be inverted.
-     * \return ClassProject::BDD_ID
+     * \return ClassProject::BDD
      *
      */
-    ClassProject::BDD_ID NotGate(const set_of_circuit_t &node);
+    ClassProject::BDD NotGate(const set_of_circuit_t &node);
 
     /**
      * \brief Generates the BDD node equivalent to the AND gate.
      * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
-     * \return ClassProject::BDD_ID
+     * \return ClassProject::BDD
      *
      */
-    ClassProject::BDD_ID AndGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD AndGate(const set_of_circuit_t &inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the OR gate.
      * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
-     * \return ClassProject::BDD_ID
+     * \return ClassProject::BDD
      *
      */
-    ClassProject::BDD_ID OrGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD OrGate(const set_of_circuit_t &inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the NAND gate.
      * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
-     * \return ClassProject::BDD_ID
+     * \return ClassProject::BDD
      *
      */
-    ClassProject::BDD_ID NandGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD NandGate(const set_of_circuit_t &inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the NOR gate.
      * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
-     * \return ClassProject::BDD_ID
+     * \return ClassProject::BDD
      *
      */
-    ClassProject::BDD_ID NorGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD NorGate(const set_of_circuit_t &inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the XOR gate.
      * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
-     * \return ClassProject::BDD_ID
+     * \return ClassProject::BDD
      *
      */
-    ClassProject::BDD_ID XorGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD XorGate(const set_of_circuit_t &inputNodes);
 
     void dumpBddText(std::ostream &out);
 
@@ -0,0 +1,105 @@
+//
+// Sequential front-end for the reachability analysis
+//
+
+#include "CircuitToReachability.hpp"
+
+
+CircuitToReachability::~CircuitToReachability() = default;
+
+std::unique_ptr<ClassProject::Reachability> CircuitToReachability::GenerateModel(const list_of_circuit_t &circuit) {
+    state_labels.clear();
+    input_labels.clear();
+
+    /* Flip flops first: their pseudo-inputs share the flip flop's label */
+    std::unordered_map<label_t, size_t> state_index;
+    for (const auto &circuit_node : circuit) {
+        if (circuit_node.gate_type == FLIP_FLOP_GATE_T) {
+            state_index.emplace(circuit_node.label, state_labels.size());
+            state_labels.push_back(circuit_node.label);
+        }
+    }
+    std::unordered_map<label_t, size_t> input_index;
+    for (const auto &circuit_node : circuit) {
+        if (circuit_node.gate_type == INPUT_GATE_T && !state_index.count(circuit_node.label)) {
+            input_index.emplace(circuit_node.label, input_labels.size());
+            input_labels.push_back(circuit_node.label);
+        }
+    }
+    if (state_labels.empty()) {
+        throw std::runtime_error("CircuitToReachability::GenerateModel: the circuit has no flip flops");
+    }
+
+    auto model = std::make_unique<ClassProject::Reachability>(state_labels.size(), input_labels.size());
+    ClassProject::Reachability &mgr = *model;
+
+    std::unordered_map<unique_ID_t, ClassProject::BDD> node_to_bdd;
+    std::vector<ClassProject::BDD_ID> next_state(state_labels.size());
+    for (const auto &circuit_node : circuit) {
+        const auto &inputs = circuit_node.input_id_list;
+        ClassProject::BDD BDD_node;
+
+        if (circuit_node.gate_type == INPUT_GATE_T) {
+            const auto state = state_index.find(circuit_node.label);
+            BDD_node = state != state_index.end()
+                       ? ClassProject::BDD(mgr, mgr.getStates().at(state->second))
+                       : ClassProject::BDD(mgr, mgr.getInputs().at(input_index.at(circuit_node.label)));
+        } else if (circuit_node.gate_type == FLIP_FLOP_GATE_T) {
+            next_state.at(state_index.at(circuit_node.label)) = findBdd(node_to_bdd, *inputs.begin()).id();
+            continue;
+        } else if (circuit_node.gate_type == OUTPUT_GATE_T) {
+            /* Primary outputs do not affect the state space */
+            continue;
+        } else if (circuit_node.gate_type == NOT_GATE_T) {
+            BDD_node = ~findBdd(node_to_bdd, *inputs.begin());
+        } else if (circuit_node.gate_type == BUFFER_GATE_T) {
+            BDD_node = findBdd(node_to_bdd, *inputs.begin());
+        } else if (circuit_node.gate_type == AND_GATE_T || circuit_node.gate_type == NAND_GATE_T ||
+                   circuit_node.gate_type == OR_GATE_T || circuit_node.gate_type == NOR_GATE_T ||
+                   circuit_node.gate_type == XOR_GATE_T) {
+            auto it = inputs.begin();
+            BDD_node = findBdd(node_to_bdd, *it);
+            while (++it != inputs.end()) {
+                const auto &operand = findBdd(node_to_bdd, *it);
+                if (circuit_node.gate_type == AND_GATE_T || circuit_node.gate_type == NAND_GATE_T) {
+                    BDD_node &= operand;
+                } else if (circuit_node.gate_type == OR_GATE_T || circuit_node.gate_type == NOR_GATE_T) {
+                    BDD_node |= operand;
+                } else {
+                    BDD_node ^= operand;
+                }
+            }
+            if (circuit_node.gate_type == NAND_GATE_T || circuit_node.gate_type == NOR_GATE_T) {
+                BDD_node = ~BDD_node;
+            }
+        } else {
+            /* Whatever the number of inputs, an unsupported gate must not pass as a buffer */
+            throw std::runtime_error("CircuitToReachability::GenerateModel: unknown gate " + circuit_node.gate_type);
+        }
+        node_to_bdd.emplace(circuit_node.id, BDD_node);
+    }
+
+    /* The model holds the next-state functions from here on, the gate handles may go */
+    mgr.setTransitionFunctions(next_state);
+    mgr.setInitState(std::vector<bool>(state_labels.size(), false));
+    return model;
+}
+
+const std::vector<label_t> &CircuitToReachability::GetStateLabels() const {
+    return state_labels;
+}
+
+const std::vector<label_t> &CircuitToReachability::GetInputLabels() const {
+    return input_labels;
+}
+
+const ClassProject::BDD &CircuitToReachability::findBdd(const std::unordered_map<unique_ID_t, ClassProject::BDD> &node_to_bdd,
+                                                        unique_ID_t circuit_node) {
+    auto bdd_it = node_to_bdd.find(circuit_node);
+
+    if (bdd_it != node_to_bdd.end()) {
+        return bdd_it->second;
+    } else {
+        throw std::runtime_error("Destination node ID is not part of the circuit graph!");
+    }
+}
@@ -0,0 +1,67 @@
+//
+// Sequential front-end for the reachability analysis
+//
+
+#pragma once
+
+#include "BenchParser.hpp"
+#include "../reachability/Reachability.h"
+
+#include <memory>
+
+
+/**
+ * \class CircuitToReachability
+ *
+ * \brief Class to convert sequential circuits into a reachability model
+ *
+ *  BenchParser splits every flip flop into a pseudo-input, carrying the flip flop's label, and a
+ *   DFF node whose input is the next-state signal. The pseudo-inputs become the state bits, the
+ *   primary inputs the input bits, and the next-state signals are built gate by gate as in
+ *   CircuitToBDD. All flip flops start at zero (ISCAS89 convention).
+ *
+ */
+class CircuitToReachability {
+
+public:
+
+    CircuitToReachability() = default;
+    ~CircuitToReachability();
+
+    /**
+     * \brief Builds the reachability model of a sequential circuit
+     * \param circuit topologically sorted list containing the circuit nodes
+     * \return the model, with one state bit per flip flop and one input bit per primary input
+     *
+     *  Flip flops and primary inputs are numbered in the order of the sorted circuit,
+     *   see GetStateLabels and GetInputLabels. Gates other than NOT, BUFF, AND, NAND, OR, NOR and XOR
+     *   throw std::runtime_error.
+     */
+    std::unique_ptr<ClassProject::Reachability> GenerateModel(const list_of_circuit_t &circuit);
+
+    /**
+     * \brief Labels of the flip flops, in the order of the state bits
+     * \return std::vector<label_t>
+     */
+    const std::vector<label_t> &GetStateLabels() const;
+
+    /**
+     * \brief Labels of the primary inputs, in the order of the input bits
+     * \return std::vector<label_t>
+     */
+    const std::vector<label_t> &GetInputLabels() const;
+
+private:
+
+    std::vector<label_t> state_labels; ///< Flip flop labels, index = state bit
+    std::vector<label_t> input_labels; ///< Primary input labels, index = input bit
+
+    /**
+     * \brief Returns the BDD of the given circuit ID
+     * \param node_to_bdd mapping from circuit node IDs to their BDDs
+     * \param circuit_node is unique_ID_t
+     * \return ClassProject::BDD
+     */
+    static const ClassProject::BDD &findBdd(const std::unordered_map<unique_ID_t, ClassProject::BDD> &node_to_bdd,
+                                            unique_ID_t circuit_node);
+};
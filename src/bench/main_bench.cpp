@@ -11,14 +11,58 @@
 #include "CircuitToBDD.hpp"
 #include "BenchmarkLib.h"
 
+/* Print the Manager performance counters next to the runtime and memory figures */
+static void printStats(const ClassProject::ManagerStats &stats) {
+    std::cout << "**** Manager Statistics ****" << std::endl;
+    std::cout << " ITE calls: " << stats.iteCalls << "; terminal hits: " << stats.iteTerminalHits
+              << "; canonicalized: " << stats.iteCanonicalized << std::endl;
+    std::cout << " Computed table: lookups: " << stats.computedLookups << "; hits: " << stats.computedHits
+              << "; misses: " << stats.computedMisses << "; evictions: " << stats.computedEvictions << std::endl;
+    std::cout << " Unique table: lookups: " << stats.uniqueLookups << "; inserts: " << stats.uniqueInserts
+              << "; probe length (total/max): " << stats.uniqueProbeLength << "/" << stats.uniqueMaxProbeLength << std::endl;
+    std::cout << " Peak nodes: " << stats.peakNodes << std::endl << std::endl;
+}
+
+/* Dump runtime, memory and Manager counters as a single JSON object */
+static void writeStatsJson(const std::string &file_name, const ClassProject::ManagerStats &stats,
+                           double runtime, double vm, double rss) {
+    std::ofstream out(file_name);
+    if (!out.is_open()) {
+        throw std::runtime_error("Unable to open statistics file " + file_name);
+    }
+    out << "{\n"
+        << "  \"Runtime\": " << runtime << ",\n"
+        << "  \"VM\": " << vm << ",\n"
+        << "  \"RSS\": " << rss << ",\n"
+        << "  \"statsEnabled\": " << (stats.enabled ? "true" : "false") << ",\n"
+        << "  \"iteCalls\": " << stats.iteCalls << ",\n"
+        << "  \"iteTerminalHits\": " << stats.iteTerminalHits << ",\n"
+        << "  \"iteCanonicalized\": " << stats.iteCanonicalized << ",\n"
+        << "  \"computedLookups\": " << stats.computedLookups << ",\n"
+        << "  \"computedHits\": " << stats.computedHits << ",\n"
+        << "  \"computedMisses\": " << stats.computedMisses << ",\n"
+        << "  \"computedEvictions\": " << stats.computedEvictions << ",\n"
+        << "  \"uniqueLookups\": " << stats.uniqueLookups << ",\n"
+        << "  \"uniqueInserts\": " << stats.uniqueInserts << ",\n"
+        << "  \"uniqueProbeLength\": " << stats.uniqueProbeLength << ",\n"
+        << "  \"uniqueMaxProbeLength\": " << stats.uniqueMaxProbeLength << ",\n"
+        << "  \"peakNodes\": " << stats.peakNodes << "\n"
+        << "}\n";
+}
+
 int main(int argc, char *argv[]) {
 
     if (2 > argc) {
         std::cout << "Must specify a filename!" << std::endl;
+        std::cout << "Usage: " << argv[0] << " <file.bench> [--stats-json <file.json>]" << std::endl;
         return -1;
     }
 
     std::string bench_file = argv[1];
+    std::string stats_json_file;
+    if (argc >= 4 && std::string(argv[2]) == "--stats-json") {
+        stats_json_file = argv[3];
+    }
 
     /* Parse the circuit from file and generate topological sorted circuit */
     BenchParser parsed_circuit(bench_file);
@@ -42,5 +86,13 @@ int main(int argc, char *argv[]) {
     process_mem_usage(vm2, rss2);
     std::cout << " VM: " << vm2 - vm1 << "; RSS: " << rss2 - rss1 << endl << endl;
 
+    const auto stats = BDD_manager->stats();
+    if (stats.enabled) {
+        printStats(stats);
+    }
+    if (!stats_json_file.empty()) {
+        writeStatsJson(stats_json_file, stats, user_time, vm2 - vm1, rss2 - rss1);
+    }
+
     return 0;
 }
@@ -0,0 +1,72 @@
+//
+// Reachability benchmark: full fixpoint over a sequential ISCAS89 circuit
+//
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "BenchParser.hpp"
+#include "CircuitToReachability.hpp"
+#include "BenchmarkLib.h"
+
+int main(int argc, char *argv[]) {
+
+    if (2 > argc) {
+        std::cout << "Must specify a filename!" << std::endl;
+        std::cout << "Usage: " << argv[0] << " <file.bench> [--threads <n>] [--trace <file.jsonl>]" << std::endl;
+        return -1;
+    }
+
+    std::string bench_file = argv[1];
+    unsigned int threads = 1;
+    std::string trace_file;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (std::string(argv[i]) == "--threads") {
+            threads = std::stoul(argv[i + 1]);
+        } else if (std::string(argv[i]) == "--trace") {
+            trace_file = argv[i + 1];
+        }
+    }
+
+    /* Parse the circuit from file and generate topological sorted circuit */
+    BenchParser parsed_circuit(bench_file);
+
+    CircuitToReachability circuit2model;
+    double user_time, vm1, rss1, vm2, rss2;
+
+    std::cout << "- Generating reachability model from circuit...";
+    process_mem_usage(vm1, rss1);
+    user_time = userTime();
+    auto model = circuit2model.GenerateModel(parsed_circuit.GetSortedCircuit());
+    model->setImageThreads(threads);
+    if (!trace_file.empty()) {
+        model->setIterationTrace(trace_file);
+    }
+    user_time = userTime() - user_time;
+    std::cout << " Model generated successfully!" << std::endl;
+    std::cout << " State bits: " << circuit2model.GetStateLabels().size()
+              << "; input bits: " << circuit2model.GetInputLabels().size()
+              << "; runtime: " << user_time << std::endl << std::endl;
+
+    std::cout << "- Computing reachable states...";
+    const auto start = std::chrono::steady_clock::now();
+    user_time = userTime();
+    model->computeReachableStates();
+    user_time = userTime() - user_time;
+    const std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - start;
+    std::cout << " Done!" << std::endl << std::endl;
+
+    const ClassProject::BDD_ID reachable = model->getReachableStates();
+    std::cout << "**** Reachable States ****" << std::endl;
+    std::cout << " States: " << model->countStates(reachable)
+              << "; BDD nodes: " << model->nodeCount(reachable) << std::endl << std::endl;
+
+    std::cout << "**** Performance ****" << std::endl;
+    std::cout << " Runtime: " << user_time << "; wall time: " << wall_time.count() << std::endl;
+    process_mem_usage(vm2, rss2);
+    std::cout << " VM: " << vm2 - vm1 << "; RSS: " << rss2 - rss1 << std::endl;
+    std::cout << " Manager nodes: " << model->uniqueTableSize() << std::endl << std::endl;
+
+    return 0;
+}
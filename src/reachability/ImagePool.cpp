@@ -0,0 +1,73 @@
+#include "ImagePool.h"
+
+namespace ClassProject {
+
+// Constructor: starts the threads, they sleep until the first run.
+ImagePool::ImagePool(const unsigned int size) {
+    for (unsigned int w = 0; w < size; ++w) {
+        threads.emplace_back([this, w] { work(w); });
+    }
+}
+
+// Destructor: wakes the threads with the stop flag and joins them.
+ImagePool::~ImagePool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+// Returns the number of threads.
+unsigned int ImagePool::size() const {
+    return static_cast<unsigned int>(threads.size());
+}
+
+// Thread loop. An exception of the task is kept for run(), the thread always reports back, so run() never
+// waits for a thread that has given up.
+void ImagePool::work(const unsigned int w) {
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return stop || generation != seen; });
+        if (stop) {
+            return;
+        }
+        seen = generation;
+        lock.unlock();
+        std::exception_ptr failure;
+        try {
+            task(w);
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        lock.lock();
+        if (failure && !error) {
+            error = failure;
+        }
+        if (--running == 0) {
+            done.notify_one();
+        }
+    }
+}
+
+// Hands job to every thread, waits until all are done and rethrows the first exception.
+void ImagePool::run(std::function<void(unsigned int)> job) {
+    std::unique_lock<std::mutex> lock(mutex);
+    task = std::move(job);
+    running = threads.size();
+    error = nullptr;
+    generation++;
+    wake.notify_all();
+    done.wait(lock, [&] { return running == 0; });
+    if (error) {
+        std::exception_ptr failure = error;
+        error = nullptr;
+        std::rethrow_exception(failure);
+    }
+}
+
+} // namespace ClassProject
@@ -0,0 +1,50 @@
+#ifndef VDSPROJECT_IMAGEPOOL_H
+#define VDSPROJECT_IMAGEPOOL_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ClassProject {
+
+// Threads of the parallel image. run() hands a task to every thread and returns once all have finished it,
+// between two runs the threads sleep on a condition variable.
+class ImagePool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::function<void(unsigned int)> task; // called with the index of the thread
+    size_t generation = 0;                  // number of tasks handed out
+    size_t running = 0;                     // threads still working on the current task
+    std::exception_ptr error;               // first exception thrown by the current task
+    bool stop = false;
+
+    // Loop of thread w: wait for a task, run it, report back.
+    void work(unsigned int w);
+
+public:
+    // Starts size threads.
+    explicit ImagePool(unsigned int size);
+
+    // Stops and joins the threads.
+    ~ImagePool();
+
+    ImagePool(const ImagePool &) = delete;
+    ImagePool &operator=(const ImagePool &) = delete;
+
+    // Number of threads.
+    unsigned int size() const;
+
+    // Calls job(w) on every thread w and waits for all of them. If a call throws, the other threads still
+    // finish and the first exception is rethrown here; the pool stays usable.
+    void run(std::function<void(unsigned int)> job);
+};
+
+} // namespace ClassProject
+
+#endif
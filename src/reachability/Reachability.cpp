@@ -2,10 +2,22 @@
 #include <stdexcept>
 #include <queue>
 #include <set>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
 #include <sys/stat.h>
 
 namespace ClassProject {
 
+using Clock = std::chrono::steady_clock;
+
+// Seconds elapsed since start.
+static double secondsSince(const Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
 // Constructor: initializes BDD variables for states and inputs, and sets default transition and initial state.
 Reachability::Reachability(unsigned int stateSize, unsigned int inputSize)
     : ReachabilityInterface(stateSize, inputSize), stateSize(stateSize), inputSize(inputSize) {
@@ -17,11 +29,16 @@ Reachability::Reachability(unsigned int stateSize, unsigned int inputSize)
     for (unsigned int i = 0; i < stateSize; ++i) {
         stateBits.push_back(Manager::createVar("s" + std::to_string(i)));
         nextStateBits.push_back(Manager::createVar("s'" + std::to_string(i)));
+        nextToCurrent.emplace(nextStateBits.back(), stateBits.back());
+        eventRename.emplace(nextStateBits.back(), stateBits.back());
+        eventRename.emplace(stateBits.back(), stateBits.back());
+        stateIndex.emplace(stateBits.back(), i);
     }
 
     // Create BDD variables for input bits if any.
     for (unsigned int i = 0; i < inputSize; ++i) {
         inputBits.push_back(Manager::createVar("x" + std::to_string(i)));
+        inputIndex.emplace(inputBits.back(), i);
     }
 
     // Set default transition functions to the identity (stateBits).
@@ -48,17 +65,28 @@ void Reachability::setInitState(const std::vector<bool> &stateVector) {
         throw std::runtime_error("Initial state size mismatch with state size.");
     }
 
-    // Start with the universal true BDD.
-    initialStates = Manager::True();
+    // A single minterm over the state bits
+    initialStates = BDD(*this, cube(stateBits, stateVector));
+    invalidate(true);
+}
 
-    // Constrain the initialStates BDD for each state bit.
-    for (int i = 0; i < stateSize; ++i) { // TODO: change to iterator based loops
-        if (stateVector.at(i)) {
-            initialStates = and2(initialStates, stateBits.at(i));
-        } else {
-            initialStates = and2(initialStates, neg(stateBits.at(i)));
+// Sets the initial states to an arbitrary set over the state bits.
+void Reachability::setInitStates(const BDD_ID initialStates) {
+    if (!Manager::isValidId(initialStates)) {
+        throw std::runtime_error("State set does not exist.");
+    }
+    if (initialStates == Manager::False()) {
+        throw std::runtime_error("Initial state set is empty.");
+    }
+    std::set<BDD_ID> vars;
+    findVars(initialStates, vars);
+    for (const BDD_ID var : vars) {
+        if (!stateIndex.count(var)) {
+            throw std::runtime_error("Initial states may only depend on state bits.");
         }
     }
+    this->initialStates = BDD(*this, initialStates);
+    invalidate(true);
 }
 
 // Sets transition functions ensuring there is exactly one function per state bit and that they exist.
@@ -68,156 +96,1036 @@ void Reachability::setTransitionFunctions(const std::vector<BDD_ID> &transitionF
         throw std::runtime_error("Transition function size mismatch with state size.");
     }
 
-    // Validate each transition function using Manager's unique table size.
+    // Validate each transition function against the Manager's unique table.
     for (const auto transition_id : transitionFunctions) {
-        if (Manager::uniqueTableSize() < transition_id) {
+        if (!Manager::isValidId(transition_id)) {
             throw std::runtime_error("Transition function does not exist.");
         }
     }
 
-    // Check that each transition function interacts with BDD nodes.
-    for (unsigned int i = 0; i < stateSize; ++i) {
-        std::set<BDD_ID> tempSet = {};
-        Manager::findNodes(transitionFunctions.at(i), tempSet);
-        if (tempSet.empty()) {
-            throw std::runtime_error("Transition function does not exist.");
+    this->transitionFunctions.clear();
+    for (const auto transition_id : transitionFunctions) {
+        this->transitionFunctions.emplace_back(*this, transition_id);
+    }
+    invalidate(false);
+}
+
+// Computes the image (next state set) from the current state set using the transition relation.
+BDD Reachability::computeImage(const BDD &currentStates, const TransitionRelation &transitionRelation) {
+    // The clock is only read while telemetry is enabled
+    const bool timed = static_cast<bool>(iterationCallback);
+    const Clock::time_point start = timed ? Clock::now() : Clock::time_point();
+
+    BDD img;
+    if (imageThreads > 1 && (imageMinNodes == 0 || nodeCount(currentStates.id()) >= imageMinNodes)) {
+        img = computeImageParallel(currentStates, transitionRelation);
+    } else {
+        // Conjoin the clusters one by one, quantifying state and input bits as soon as no later cluster uses them.
+        BDD temp(*this, exists(currentStates.id(), transitionRelation.quantifyFirst.id()));
+        for (size_t j = 0; j < transitionRelation.clusters.size(); ++j) {
+            temp = BDD(*this, andExists(temp.id(), transitionRelation.clusters[j].id(), transitionRelation.quantify[j].id()));
+        }
+        if (timed) {
+            iterationStats.quantifySeconds += secondsSince(start);
         }
+
+        // Rename next state bits to state bits. Each s'i directly follows si in the variable order, so the
+        // renaming keeps the order and copies the nodes one to one (document section 8).
+        img = BDD(*this, Manager::transfer(*this, temp.id(), *this, nextToCurrent));
     }
 
-    this->transitionFunctions = transitionFunctions;
+    if (timed) {
+        iterationStats.imageSeconds += secondsSince(start);
+        iterationStats.peakNodes = std::max(iterationStats.peakNodes, uniqueTableSize());
+    }
+    return img;
 }
 
-// Computes the image (next state set) from the current state set using the transition relation.
-BDD_ID Reachability::computeImage(const BDD_ID &currentStates, const BDD_ID &transitionRelation) {
-    // Combine current states with transition relation.
-    BDD_ID temp = and2(currentStates, transitionRelation);
+// Preimage: substitute the transition functions for the state bits, then quantify the inputs.
+BDD Reachability::computePreimage(const BDD &states) {
+    std::unordered_map<BDD_ID, BDD_ID> substitution;
+    for (unsigned int i = 0; i < stateSize; ++i) {
+        substitution.emplace(stateBits[i], transitionFunctions[i].id());
+    }
+    const bool timed = static_cast<bool>(iterationCallback);
+    const Clock::time_point start = timed ? Clock::now() : Clock::time_point();
+
+    const BDD composed(*this, vectorCompose(states.id(), substitution));
+    const Clock::time_point quantifyStart = timed ? Clock::now() : Clock::time_point();
+    BDD pre(*this, exists(composed.id(), cubeOf(inputBits).id()));
+
+    if (timed) {
+        iterationStats.quantifySeconds += secondsSince(quantifyStart);
+        iterationStats.imageSeconds += secondsSince(start);
+        iterationStats.peakNodes = std::max(iterationStats.peakNodes, uniqueTableSize());
+    }
+    return pre;
+}
+
+// Image on raw IDs, used by the workers on their forks.
+BDD_ID Reachability::imageIn(Manager &manager, const BDD_ID states, const TransitionRelation &transitionRelation,
+                             const std::unordered_map<BDD_ID, BDD_ID> &rename) {
+    BDD_ID temp = manager.exists(states, transitionRelation.quantifyFirst.id());
+    for (size_t j = 0; j < transitionRelation.clusters.size(); ++j) {
+        temp = manager.andExists(temp, transitionRelation.clusters[j].id(), transitionRelation.quantify[j].id());
+    }
+    return Manager::transfer(manager, temp, manager, rename);
+}
 
-    // Perform existential quantification over state and input bits.
-    for (const auto &state_bit : stateBits) {
-        temp = or2(coFactorTrue(temp, state_bit), coFactorFalse(temp, state_bit));
+// Parallel image: split the states on the top state bits, image the pieces in forks, OR the results.
+BDD Reachability::computeImageParallel(const BDD &currentStates, const TransitionRelation &transitionRelation) {
+    // The workers fork after the relation is built, so the clusters live in their frozen base
+    if (imageWorkers.size() != imageThreads) {
+        imageWorkers.clear();
+        for (unsigned int w = 0; w < imageThreads; ++w) {
+            imageWorkers.push_back(fork());
+        }
     }
-    for (const auto &input_bit : inputBits) {
-        temp = or2(coFactorTrue(temp, input_bit), coFactorFalse(temp, input_bit));
+    if (!imagePool) {
+        imagePool = std::make_unique<ImagePool>(imageThreads);
     }
 
-    // Compute image using xnor for next state bits (part 3 image computation: document section 8.1)
-    BDD_ID img = xnor2(stateBits.at(0), nextStateBits.at(0));
-    img = and2(img, temp);
+    // Disjoint pieces: currentStates restricted to every assignment of the top split bits
+    unsigned int split = 0;
+    while ((1u << split) < imageThreads && split < stateSize) {
+        split++;
+    }
+    std::vector<BDD> pieces;
+    for (unsigned int p = 0; p < (1u << split); ++p) {
+        BDD piece = currentStates;
+        for (unsigned int k = 0; k < split; ++k) {
+            const BDD bit(*this, stateBits[k]);
+            piece &= (p >> k & 1) ? bit : ~bit;
+        }
+        if (piece.id() != Manager::False()) {
+            pieces.push_back(std::move(piece));
+        }
+    }
 
-    // Refine image for remaining state bits.
-    for (int i = 1; i < stateSize; ++i) {
-        temp = and2(temp, xnor2(stateBits.at(i), nextStateBits.at(i)));
-        img = and2(img, temp);
+    // Every variable keeps its ID in the forks
+    std::unordered_map<BDD_ID, BDD_ID> identity;
+    for (const BDD_ID var : stateBits) {
+        identity.emplace(var, var);
+    }
+    for (const BDD_ID var : nextStateBits) {
+        identity.emplace(var, var);
+    }
+    for (const BDD_ID var : inputBits) {
+        identity.emplace(var, var);
     }
 
-    // Finalize image computation by abstracting next state bits (document section 8.2)
-    for (int i = stateSize - 1; i >= 0; --i) {
-        img = or2(coFactorTrue(img, nextStateBits.at(i)), coFactorFalse(img, nextStateBits.at(i)));
+    // Workers only read this manager (to copy their pieces in) while it is idle
+    const bool timed = static_cast<bool>(iterationCallback);
+    const Clock::time_point start = timed ? Clock::now() : Clock::time_point();
+    std::vector<BDD_ID> partial(pieces.size(), Manager::False());
+    imagePool->run([&](const unsigned int w) {
+        if (w >= pieces.size()) {
+            return;
+        }
+        Manager &worker = *imageWorkers[w];
+        worker.garbageCollect(); // drop the nodes of the previous step, the frozen base stays
+        for (size_t p = w; p < pieces.size(); p += imageWorkers.size()) {
+            const BDD_ID states = Manager::transfer(*this, pieces[p].id(), worker, identity);
+            partial[p] = imageIn(worker, states, transitionRelation, nextToCurrent);
+        }
+    });
+    if (timed) {
+        iterationStats.quantifySeconds += secondsSince(start); // renaming in the workers included
     }
 
+    BDD img(*this, Manager::False());
+    for (size_t p = 0; p < pieces.size(); ++p) {
+        img |= BDD(*this, Manager::transfer(*imageWorkers[p % imageWorkers.size()], partial[p], *this, identity));
+    }
     return img;
 }
 
+// Conjunction of the given variables, built bottom-up.
+BDD Reachability::cubeOf(const std::vector<BDD_ID> &vars) {
+    return BDD(*this, cube(vars));
+}
+
+// Builds the transition relation and its quantification schedule.
+Reachability::TransitionRelation Reachability::buildTransitionRelation() {
+    std::vector<BDD_ID> quantified(stateBits);
+    quantified.insert(quantified.end(), inputBits.begin(), inputBits.end());
+
+    TransitionRelation relation;
+    if (imageMethod == ImageMethod::Monolithic) {
+        relation.quantifyFirst = BDD(*this, Manager::True());
+        relation.clusters.push_back(computeTransitionRelation());
+        relation.quantify.push_back(cubeOf(quantified));
+        relation.members.emplace_back();
+        for (unsigned int i = 0; i < stateSize; ++i) {
+            relation.members.back().push_back(i);
+        }
+        return relation;
+    }
+
+    // One partition s'i <-> delta_i per state bit, with its support among the quantified variables.
+    struct Partition {
+        BDD relation;
+        std::set<BDD_ID> support;
+        std::vector<unsigned int> members;
+    };
+    const std::set<BDD_ID> quantifiable(quantified.begin(), quantified.end());
+    std::vector<Partition> pending;
+    std::map<BDD_ID, size_t> users; // variable -> number of pending partitions depending on it
+    for (unsigned int i = 0; i < stateSize; ++i) {
+        Partition partition{BDD(*this, xnor2(nextStateBits.at(i), transitionFunctions.at(i).id())), {}, {i}};
+        std::set<BDD_ID> vars;
+        findVars(partition.relation.id(), vars);
+        for (const BDD_ID var : vars) {
+            if (quantifiable.count(var)) {
+                partition.support.insert(var);
+                users[var]++;
+            }
+        }
+        pending.push_back(std::move(partition));
+    }
+
+    // IWLS95 ordering: next take the partition that allows the most variables to be quantified
+    // (no other pending partition uses them) relative to the variables it newly introduces.
+    std::vector<Partition> ordered;
+    std::set<BDD_ID> introduced;
+    while (!pending.empty()) {
+        size_t best = 0;
+        double best_score = -1;
+        for (size_t k = 0; k < pending.size(); ++k) {
+            size_t released = 0, fresh = 0;
+            for (const BDD_ID var : pending[k].support) {
+                released += users[var] == 1;
+                fresh += introduced.count(var) == 0;
+            }
+            const double score = (released + 1.0) / (fresh + 1.0);
+            if (score > best_score) {
+                best = k;
+                best_score = score;
+            }
+        }
+        for (const BDD_ID var : pending[best].support) {
+            users[var]--;
+            introduced.insert(var);
+        }
+        ordered.push_back(std::move(pending[best]));
+        pending.erase(pending.begin() + static_cast<long>(best));
+    }
+
+    // Clustering: merge consecutive partitions while the cluster stays below the threshold.
+    std::vector<Partition> clusters;
+    for (Partition &partition : ordered) {
+        if (!clusters.empty()) {
+            const BDD_ID merged = andLimit(clusters.back().relation.id(), partition.relation.id(), clusterThreshold,
+                                           relationApplyMode);
+            if (merged != InvalidId && nodeCount(merged) <= clusterThreshold) {
+                clusters.back().relation = BDD(*this, merged);
+                clusters.back().support.insert(partition.support.begin(), partition.support.end());
+                clusters.back().members.push_back(partition.members.front());
+                continue;
+            }
+        }
+        clusters.push_back(std::move(partition));
+    }
+
+    std::vector<std::set<BDD_ID>> supports;
+    for (Partition &cluster : clusters) {
+        relation.clusters.push_back(std::move(cluster.relation));
+        relation.members.push_back(std::move(cluster.members));
+        supports.push_back(std::move(cluster.support));
+    }
+    scheduleQuantification(relation, supports);
+    return relation;
+}
+
+// Schedule: quantify every state and input bit after the last cluster depending on it.
+void Reachability::scheduleQuantification(TransitionRelation &relation, const std::vector<std::set<BDD_ID>> &supports) {
+    std::map<BDD_ID, size_t> last_use;
+    for (size_t j = 0; j < supports.size(); ++j) {
+        for (const BDD_ID var : supports[j]) {
+            last_use[var] = j;
+        }
+    }
+    std::vector<BDD_ID> quantified(stateBits);
+    quantified.insert(quantified.end(), inputBits.begin(), inputBits.end());
+    std::vector<std::vector<BDD_ID>> schedule(relation.clusters.size());
+    std::vector<BDD_ID> first;
+    for (const BDD_ID var : quantified) {
+        const auto use = last_use.find(var);
+        if (use == last_use.end()) {
+            first.push_back(var);
+        } else {
+            schedule[use->second].push_back(var);
+        }
+    }
+    relation.quantifyFirst = cubeOf(first);
+    relation.quantify.clear();
+    for (size_t j = 0; j < relation.clusters.size(); ++j) {
+        relation.quantify.push_back(cubeOf(schedule[j]));
+    }
+}
+
+// Replaces some transition functions, patching the cached relation and keeping a seed where possible.
+bool Reachability::updateTransitionFunctions(const std::map<unsigned int, BDD_ID> &changes) {
+    for (const auto &change : changes) {
+        if (change.first >= stateSize) {
+            throw std::runtime_error("State bit index out of range.");
+        }
+        if (!Manager::isValidId(change.second)) {
+            throw std::runtime_error("Transition function does not exist.");
+        }
+    }
+
+    // The old reachable set stays a valid seed if every old transition out of it still exists. OverApproximate
+    // results are no exact reachable sets and are never reused.
+    BDD seed;
+    if (reachableValid && traversalMode != TraversalMode::OverApproximate) {
+        // Only the changed bits and the bits sharing an input with them (transitively) need to be compared:
+        // the other bits keep their functions and draw on disjoint inputs, so their transitions factor out.
+        std::vector<std::set<BDD_ID>> inputs(stateSize);
+        for (unsigned int i = 0; i < stateSize; ++i) {
+            std::set<BDD_ID> vars;
+            findVars(transitionFunctions[i].id(), vars);
+            if (changes.count(i)) {
+                findVars(changes.at(i), vars);
+            }
+            for (const BDD_ID var : vars) {
+                if (inputIndex.count(var)) {
+                    inputs[i].insert(var);
+                }
+            }
+        }
+        std::set<unsigned int> bits;
+        std::set<BDD_ID> shared;
+        for (const auto &change : changes) {
+            bits.insert(change.first);
+            shared.insert(inputs[change.first].begin(), inputs[change.first].end());
+        }
+        bool grown = true;
+        while (grown) {
+            grown = false;
+            for (unsigned int i = 0; i < stateSize; ++i) {
+                const bool coupled = std::any_of(inputs[i].begin(), inputs[i].end(),
+                                                 [&](const BDD_ID var) { return shared.count(var) != 0; });
+                if (coupled && bits.insert(i).second) {
+                    shared.insert(inputs[i].begin(), inputs[i].end());
+                    grown = true;
+                }
+            }
+        }
+
+        const BDD before = successorRelation(reachableStates, bits);
+        std::vector<BDD> previous = transitionFunctions;
+        for (const auto &change : changes) {
+            transitionFunctions[change.first] = BDD(*this, change.second);
+        }
+        const BDD after = successorRelation(reachableStates, bits);
+        transitionFunctions = std::move(previous);
+        if (!intersects(before.id(), neg(after.id()))) {
+            seed = reachableStates;
+        }
+    }
+
+    for (const auto &change : changes) {
+        transitionFunctions[change.first] = BDD(*this, change.second);
+    }
+    if (relationValid) {
+        // Only the clusters holding a changed bit are conjoined again, the supports of all clusters are cheap
+        // to recover and give the new quantification schedule.
+        std::vector<std::set<BDD_ID>> supports;
+        for (size_t j = 0; j < relation.clusters.size(); ++j) {
+            const std::vector<unsigned int> &members = relation.members[j];
+            const bool affected = std::any_of(members.begin(), members.end(),
+                                              [&](const unsigned int bit) { return changes.count(bit) != 0; });
+            if (affected) {
+                BDD cluster(*this, Manager::True());
+                for (const unsigned int bit : members) {
+                    const BDD partition(*this, xnor2(nextStateBits.at(bit), transitionFunctions.at(bit).id()));
+                    cluster = BDD(*this, and2(cluster.id(), partition.id(), relationApplyMode));
+                }
+                relation.clusters[j] = std::move(cluster);
+            }
+            std::set<BDD_ID> vars, support;
+            findVars(relation.clusters[j].id(), vars);
+            for (const BDD_ID var : vars) {
+                if (stateIndex.count(var) || inputIndex.count(var)) {
+                    support.insert(var);
+                }
+            }
+            supports.push_back(std::move(support));
+        }
+        if (imageMethod == ImageMethod::Partitioned) {
+            scheduleQuantification(relation, supports);
+        }
+        imageWorkers.clear(); // the forks share the old clusters
+    }
+
+    invalidate(true);
+    seedStates = std::move(seed);
+    return seedStates.manager() != nullptr;
+}
+
+// Transitions of the given bits out of states as a relation over (s, s'), inputs quantified after their last use.
+BDD Reachability::successorRelation(const BDD &states, const std::set<unsigned int> &bits) {
+    std::map<BDD_ID, unsigned int> last_use;
+    for (const unsigned int i : bits) {
+        std::set<BDD_ID> vars;
+        findVars(transitionFunctions[i].id(), vars);
+        for (const BDD_ID var : vars) {
+            if (inputIndex.count(var)) {
+                last_use[var] = i;
+            }
+        }
+    }
+    std::vector<std::vector<BDD_ID>> schedule(stateSize);
+    for (const auto &use : last_use) {
+        schedule[use.second].push_back(use.first);
+    }
+
+    BDD result = states;
+    for (const unsigned int i : bits) {
+        const BDD partition(*this, xnor2(nextStateBits.at(i), transitionFunctions.at(i).id()));
+        result = BDD(*this, andExists(result.id(), partition.id(), cubeOf(schedule[i]).id()));
+    }
+    return result;
+}
+
 // Constructs the overall transition relation (tau) from the individual transition functions.
-BDD_ID Reachability::computeTransitionRelation() {
+BDD Reachability::computeTransitionRelation() {
     if (nextStateBits.size() != transitionFunctions.size()) {
         throw std::runtime_error("Transition function size mismatch with state size.");
     }
 
-    // Start with the relation for the first state bit.
-    BDD_ID tau = xnor2(nextStateBits.at(0), transitionFunctions.at(0));
-    BDD_ID tmp;
-
-    // Combine the relations for remaining state bits.
-    for(int i = 1; i < nextStateBits.size(); ++i) {
-        tmp = xnor2(nextStateBits.at(i), transitionFunctions.at(i));
-        tau = and2(tmp, tau);
+    // Conjoin s'_i <-> delta_i(s, x) for all state bits.
+    BDD tau(*this, Manager::True());
+    for (unsigned int i = 0; i < nextStateBits.size(); ++i) {
+        const BDD bit_relation(*this, xnor2(nextStateBits.at(i), transitionFunctions.at(i).id()));
+        tau = BDD(*this, and2(bit_relation.id(), tau.id(), relationApplyMode));
     }
 
     return tau;
 }
 
+// Selects the apply engine for building the transition relation.
+void Reachability::setTransitionRelationApplyMode(const ApplyMode mode) {
+    relationApplyMode = mode;
+    relationValid = false;
+}
+
+// Splits the transition relation into events for saturation. Event k holds the transitions whose first
+// changing state bit (in variable order) is bit k. The bits before k keep their value: instead of conjoining
+// s'j == sj, their next state bits are quantified out after substituting sj, so the event only mentions the
+// next state bits from k on and the state bits it reads. The events cover all transitions except self loops,
+// which add no states. They are grouped by the topmost bit they change or read, so an event whose inputs and
+// outputs all lie below a level fires while saturating the lower levels and leaves the upper bits alone.
+std::vector<std::vector<Reachability::SaturationEvent>> Reachability::buildSaturationEvents() {
+    BDD relation(*this, exists(computeTransitionRelation().id(), cubeOf(inputBits).id()));
+
+    std::map<BDD_ID, unsigned int> level; // state or next state bit -> index of the state bit
+    for (unsigned int i = 0; i < stateSize; ++i) {
+        level.emplace(stateBits.at(i), i);
+        level.emplace(nextStateBits.at(i), i);
+    }
+
+    std::vector<std::vector<SaturationEvent>> events(stateSize);
+    BDD unchanged(*this, Manager::True());
+    std::vector<BDD_ID> kept;
+    for (unsigned int k = 0; k < stateSize; ++k) {
+        const BDD current(*this, stateBits.at(k));
+        const BDD next(*this, nextStateBits.at(k));
+        const BDD local(*this, andExists((relation & (current ^ next)).id(), unchanged.id(), cubeOf(kept).id()));
+        unchanged &= ~(current ^ next);
+        kept.push_back(nextStateBits.at(k));
+        if (!local.isConstant()) {
+            const std::vector<BDD_ID> changed(stateBits.begin() + k, stateBits.end());
+            // deepest level first
+            events[stateSize - 1 - level.at(topVar(local.id()))].push_back(SaturationEvent{local, cubeOf(changed)});
+        }
+    }
+    return events;
+}
+
+// Successors of states under one event: only the changed bits are quantified and renamed.
+BDD Reachability::fireEvent(const BDD &states, const SaturationEvent &event) {
+    const BDD successors(*this, andExists(states.id(), event.relation.id(), event.changes.id()));
+    return BDD(*this, Manager::transfer(*this, successors.id(), *this, eventRename));
+}
+
+// Saturates the levels of groups 0 .. groups - 1 bottom-up: a group fires until it adds nothing new, and
+// after every addition the deeper groups are saturated again.
+BDD Reachability::saturate(BDD states, const std::vector<std::vector<SaturationEvent>> &events, const size_t groups) {
+    for (size_t g = 0; g < groups; ++g) {
+        bool grown = true;
+        while (grown) {
+            grown = false;
+            for (const SaturationEvent &event : events[g]) {
+                const BDD fresh = fireEvent(states, event) & ~states;
+                if (!(fresh.isConstant() && fresh.id() == Manager::False())) {
+                    states = saturate(states | fresh, events, g);
+                    grown = true;
+                }
+            }
+        }
+    }
+    return states;
+}
+
+// Counts the saturation events per level, top level first.
+std::vector<size_t> Reachability::saturationEventCounts() {
+    const std::vector<std::vector<SaturationEvent>> events = buildSaturationEvents();
+    std::vector<size_t> counts;
+    for (auto group = events.rbegin(); group != events.rend(); ++group) {
+        counts.push_back(group->size());
+    }
+    return counts;
+}
+
+// Selects the image computation.
+void Reachability::setImageMethod(const ImageMethod method, const size_t clusterThreshold) {
+    imageMethod = method;
+    this->clusterThreshold = clusterThreshold;
+    relationValid = false;
+}
+
+// Returns the cached transition relation.
+const Reachability::TransitionRelation &Reachability::transitionRelation() {
+    if (!relationValid) {
+        imageWorkers.clear();
+        relation = buildTransitionRelation();
+        relationValid = true;
+    }
+    return relation;
+}
+
+// Drops cached results that depend on the transition functions or the initial states.
+void Reachability::invalidate(const bool keepRelation) {
+    if (!keepRelation) {
+        relation = TransitionRelation();
+        relationValid = false;
+    }
+    reachableStates = BDD();
+    reachableValid = false;
+    rings.clear();
+    seedStates = BDD();
+}
+
+// Breadth-first traversal that keeps the states of every distance.
+void Reachability::computeRings() {
+    const TransitionRelation &tau = transitionRelation();
+    const BDD none(*this, Manager::False());
+    rings.assign(1, initialStates);
+    BDD Cr = initialStates;
+    BDD from = Cr;
+    beginTraversal(SearchDirection::Forward);
+    while (true) {
+        const BDD fresh = computeImage(from, tau) & ~Cr;
+        if (fresh == none) {
+            endIteration(from, Cr);
+            break;
+        }
+        rings.push_back(fresh);
+        BDD next = nextFrontier(fresh, Cr);
+        Cr |= fresh;
+        endIteration(from, Cr);
+        from = std::move(next);
+    }
+    // The union of the rings is exact, so it also serves the reachability queries
+    if (traversalMode != TraversalMode::OverApproximate) {
+        reachableStates = Cr;
+        reachableValid = true;
+    }
+}
+
+// Selects the number of image threads.
+void Reachability::setImageThreads(const unsigned int threads, const size_t minFrontierNodes) {
+    imageThreads = std::max(1u, threads);
+    imageMinNodes = minFrontierNodes;
+    imagePool.reset();
+    imageWorkers.clear();
+}
+
+// Installs the telemetry callback.
+void Reachability::setIterationCallback(std::function<void(const IterationStats &)> callback) {
+    iterationCallback = std::move(callback);
+}
+
+// Telemetry as JSON lines, flushed after every iteration so long runs can be followed.
+void Reachability::setIterationTrace(const std::string &fileName) {
+    auto out = std::make_shared<std::ofstream>(fileName);
+    if (!out->is_open()) {
+        throw std::runtime_error("Unable to open trace file " + fileName);
+    }
+    setIterationCallback([out](const IterationStats &stats) {
+        *out << "{\"direction\": \"" << (stats.direction == SearchDirection::Backward ? "backward" : "forward")
+             << "\", \"iteration\": " << stats.iteration
+             << ", \"frontierNodes\": " << stats.frontierNodes
+             << ", \"reachedNodes\": " << stats.reachedNodes
+             << ", \"imageSeconds\": " << stats.imageSeconds
+             << ", \"quantifySeconds\": " << stats.quantifySeconds
+             << ", \"peakNodes\": " << stats.peakNodes
+             << ", \"computedHitRate\": ";
+        if (stats.computedHitRate < 0) {
+            *out << "null";
+        } else {
+            *out << stats.computedHitRate;
+        }
+        *out << "}" << std::endl;
+    });
+}
+
+// Resets the telemetry at the start of a traversal.
+void Reachability::beginTraversal(const SearchDirection direction) {
+    if (!iterationCallback) {
+        return;
+    }
+    iterationStats = IterationStats();
+    iterationStats.direction = direction;
+    iterationCounters = stats();
+    iterationStats.peakNodes = iterationCounters.enabled ? iterationCounters.peakNodes : uniqueTableSize();
+}
+
+// Reports the current iteration and starts the next one.
+void Reachability::endIteration(const BDD &frontier, const BDD &reached) {
+    if (!iterationCallback) {
+        return;
+    }
+    const ManagerStats counters = stats();
+    iterationStats.iteration++;
+    iterationStats.frontierNodes = nodeCount(frontier.id());
+    iterationStats.reachedNodes = nodeCount(reached.id());
+    if (counters.enabled) {
+        const uint64_t lookups = counters.computedLookups - iterationCounters.computedLookups;
+        const uint64_t hits = counters.computedHits - iterationCounters.computedHits;
+        iterationStats.computedHitRate = lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+        iterationStats.peakNodes = counters.peakNodes;
+    }
+    iterationCallback(iterationStats);
+
+    iterationCounters = counters;
+    iterationStats.imageSeconds = 0;
+    iterationStats.quantifySeconds = 0;
+}
+
+// Selects the traversal strategy of computeReachableStates.
+void Reachability::setTraversalMode(const TraversalMode mode, const size_t threshold, const ApproxMethod method) {
+    traversalMode = mode;
+    approxThreshold = threshold;
+    approxMethod = method;
+    // Over-approximated sets must not answer exact queries and vice versa
+    reachableStates = BDD();
+    reachableValid = false;
+}
+
+// Enables the restrict minimization of frontiers.
+void Reachability::setFrontierRestrict(const bool enabled) {
+    frontierRestrict = enabled;
+}
+
+// Returns the set to image after discovering fresh states, reached holds the states found before them.
+BDD Reachability::nextFrontier(const BDD &fresh, const BDD &reached) {
+    if (!frontierRestrict) {
+        return fresh;
+    }
+    // States reached before are don't cares: imaging them again only yields known states.
+    BDD minimized(*this, restrict(fresh.id(), neg(reached.id())));
+    return nodeCount(minimized.id()) < nodeCount(fresh.id()) ? minimized : fresh;
+}
+
 // Checks if a given state, described by a boolean vector, is reachable.
 bool Reachability::isReachable(const std::vector<bool> &stateVector) {
     if (stateVector.size() != stateSize) {
         throw std::runtime_error("State vector size mismatch with state size.");
     }
-    // Compute all reachable states.
-    computeReachableStates();
-    BDD_ID tmp = reachableStates;
+    // Compute all reachable states once, then every query is a walk through the cached set.
+    if (!reachableValid) {
+        computeReachableStates();
+    }
+    return isReachableInSet(stateVector, reachableStates);
+}
 
-    // Narrow down the BDD for each bit based on the provided stateVector.
-    for (int i = 0; i < stateSize; ++i) {
-        if (stateVector.at(i)) {
-            tmp = coFactorTrue(tmp, stateBits.at(i));
-        } else {
-            tmp = coFactorFalse(tmp, stateBits.at(i));
-        }
+// Returns the cached reachable set.
+BDD_ID Reachability::getReachableStates() {
+    if (!reachableValid) {
+        computeReachableStates();
+    }
+    return reachableStates.id();
+}
 
-        // Early exit if tmp is a terminal node.
-        if (Manager::isConstant(tmp)) {
-            // Transformation of BBD_ID to boolean value. 
-            return (tmp == Manager::True());
+// Counts the states of a set: the fraction of satisfying assignments times 2^stateSize.
+double Reachability::countStates(const BDD_ID stateSet) {
+    std::unordered_map<BDD_ID, double> fraction{{Manager::False(), 0.0}, {Manager::True(), 1.0}};
+    std::vector<BDD_ID> pending{stateSet};
+    while (!pending.empty()) {
+        const BDD_ID current = pending.back();
+        if (fraction.count(current)) {
+            pending.pop_back();
+            continue;
         }
+        const BDD_ID high = coFactorTrue(current), low = coFactorFalse(current);
+        const auto h = fraction.find(high), l = fraction.find(low);
+        if (h == fraction.end() || l == fraction.end()) {
+            if (h == fraction.end()) {
+                pending.push_back(high);
+            }
+            if (l == fraction.end()) {
+                pending.push_back(low);
+            }
+            continue;
+        }
+        pending.pop_back();
+        fraction.emplace(current, (h->second + l->second) / 2);
     }
-    return false;
+    return std::ldexp(fraction.at(stateSet), static_cast<int>(stateSize));
 }
 
 // Helper function: checks whether a given state is contained within a provided state set using BDD cofactors.
-bool Reachability::isReachableInSet(const std::vector<bool> &stateVector, const BDD_ID &stateSet) {
+bool Reachability::isReachableInSet(const std::vector<bool> &stateVector, const BDD &stateSet) {
     if (stateVector.size() != stateSize) {
         throw std::runtime_error("State vector size mismatch with state size.");
     }
-    BDD_ID tmp = stateSet;
-    for (int i = 0; i < stateSize; ++i) {
-        if (stateVector.at(i)) {
-            tmp = coFactorTrue(tmp, stateBits.at(i));
+    // Evaluate the set: follow the branch selected by each state bit down to a terminal.
+    BDD_ID tmp = stateSet.id();
+    while (!isConstant(tmp)) {
+        tmp = stateVector[stateIndex.at(topVar(tmp))] ? coFactorTrue(tmp) : coFactorFalse(tmp);
+    }
+    return tmp == Manager::True();
+}
+
+// Picks one assignment from a set over state and input bits, unconstrained bits are false.
+void Reachability::pickAssignment(BDD_ID set, std::vector<bool> &state, std::vector<bool> &input) {
+    state.assign(stateSize, false);
+    input.assign(inputSize, false);
+    while (!isConstant(set)) {
+        const BDD_ID var = topVar(set);
+        const bool value = coFactorFalse(set) == Manager::False();
+        const auto bit = stateIndex.find(var);
+        if (bit != stateIndex.end()) {
+            state[bit->second] = value;
+        } else {
+            input[inputIndex.at(var)] = value;
+        }
+        set = value ? coFactorTrue(set) : coFactorFalse(set);
+    }
+}
+
+// Shortest trace to a target state, recovered backwards through the rings.
+Trace Reachability::shortestTrace(const std::vector<bool> &targetState) {
+    const int distance = stateDistance(targetState);
+    Trace trace;
+    if (distance < 0) {
+        return trace;
+    }
+    trace.states.resize(distance + 1);
+    trace.inputs.resize(distance);
+    trace.states[distance] = targetState;
+
+    // A predecessor in ring k - 1 with an input that makes every transition function produce the successor
+    for (int k = distance; k > 0; --k) {
+        BDD step = rings[k - 1];
+        for (unsigned int i = 0; i < stateSize && step.id() != Manager::False(); ++i) {
+            step &= trace.states[k][i] ? transitionFunctions[i] : ~transitionFunctions[i];
+        }
+        pickAssignment(step.id(), trace.states[k - 1], trace.inputs[k - 1]);
+    }
+    return trace;
+}
+
+// Invariant check with early termination.
+InvariantResult Reachability::checkInvariant(const BDD_ID badStates) {
+    if (!Manager::isValidId(badStates)) {
+        throw std::runtime_error("State set does not exist.");
+    }
+    InvariantResult result;
+    auto hit = [&](const BDD &ring, const int depth) {
+        if (!intersects(ring.id(), badStates)) {
+            return false;
+        }
+        std::vector<bool> input;
+        const BDD bad(*this, and2(ring.id(), badStates));
+        pickAssignment(bad.id(), result.witness, input);
+        result.holds = false;
+        result.depth = depth;
+        return true;
+    };
+
+    // Cached rings answer without any image computation
+    if (!rings.empty()) {
+        for (size_t k = 0; k < rings.size(); ++k) {
+            if (hit(rings[k], static_cast<int>(k))) {
+                break;
+            }
+        }
+        return result;
+    }
+
+    const TransitionRelation &tau = transitionRelation();
+    const BDD none(*this, Manager::False());
+    BDD Cr = initialStates;
+    BDD from = Cr;
+    BDD fresh = Cr;
+    beginTraversal(SearchDirection::Forward);
+    for (int depth = 0; fresh != none; ++depth) {
+        if (hit(fresh, depth)) {
+            return result;
+        }
+        fresh = computeImage(from, tau) & ~Cr;
+        BDD next = nextFrontier(fresh, Cr);
+        Cr |= fresh;
+        endIteration(from, Cr);
+        from = std::move(next);
+    }
+    return result;
+}
+
+// Preimage of a state set.
+BDD_ID Reachability::preimage(const BDD_ID states) {
+    if (!Manager::isValidId(states)) {
+        throw std::runtime_error("State set does not exist.");
+    }
+    return computePreimage(BDD(*this, states)).id();
+}
+
+// Backward reachability: preimages of the new states until no new states are found.
+BDD_ID Reachability::backwardReachableStates(const BDD_ID targetStates) {
+    if (!Manager::isValidId(targetStates)) {
+        throw std::runtime_error("State set does not exist.");
+    }
+    const BDD none(*this, Manager::False());
+    BDD Br(*this, targetStates);
+    BDD from = Br;
+    beginTraversal(SearchDirection::Backward);
+    while (true) {
+        const BDD fresh = computePreimage(from) & ~Br;
+        if (fresh == none) {
+            endIteration(from, Br);
+            break;
+        }
+        Br |= fresh;
+        endIteration(from, Br);
+        from = fresh;
+    }
+    return Br.id();
+}
+
+// Shortest distance from the initial states to a target set.
+int Reachability::distanceTo(const BDD_ID targetStates, const SearchDirection direction) {
+    if (!Manager::isValidId(targetStates)) {
+        throw std::runtime_error("State set does not exist.");
+    }
+    const BDD none(*this, Manager::False());
+    const BDD target(*this, targetStates);
+
+    if (direction == SearchDirection::Forward) {
+        if (rings.empty()) {
+            computeRings();
+        }
+        for (size_t k = 0; k < rings.size(); ++k) {
+            if (intersects(rings[k].id(), targetStates)) {
+                return static_cast<int>(k);
+            }
+        }
+        return -1;
+    }
+
+    // Forward set after i images, backward set after j preimages. They intersect iff the distance is at
+    // most i + j, so the first intersection while growing one step at a time yields the exact distance.
+    const TransitionRelation &tau = transitionRelation();
+    BDD Fr = initialStates, Br = target;
+    BDD forward = Fr, backward = Br;
+    int steps = 0;
+    while (!intersects(Fr.id(), Br.id())) {
+        const bool grow_forward = direction == SearchDirection::Bidirectional &&
+                                  nodeCount(forward.id()) <= nodeCount(backward.id());
+        if (grow_forward) {
+            forward = computeImage(forward, tau) & ~Fr;
+            if (forward == none) {
+                return -1; // all reachable states are known and none is a target
+            }
+            Fr |= forward;
         } else {
-            tmp = coFactorFalse(tmp, stateBits.at(i));
+            backward = computePreimage(backward) & ~Br;
+            if (backward == none) {
+                return -1; // no initial state reaches the target
+            }
+            Br |= backward;
         }
-        if (tmp <= Manager::True()) {
-            return tmp == Manager::True();
+        steps++;
+    }
+    return steps;
+}
+
+// Checks a batch of states against the reachable set.
+std::vector<bool> Reachability::areReachable(const StateMatrix &states) {
+    if (!reachableValid) {
+        computeReachableStates();
+    }
+    return containsStates(states, reachableStates.id());
+}
+
+// Checks a batch of states against a state set, 64 rows at a time.
+std::vector<bool> Reachability::containsStates(const StateMatrix &states, const BDD_ID stateSet) {
+    if (states.bits != stateSize) {
+        throw std::runtime_error("State vector size mismatch with state size.");
+    }
+    if (!Manager::isValidId(stateSet)) {
+        throw std::runtime_error("State set does not exist.");
+    }
+
+    std::vector<bool> contained(states.rows, false);
+    std::vector<uint64_t> slices(stateSize);                          // bit i of all rows in the block
+    std::vector<std::vector<std::pair<BDD_ID, uint64_t>>> levels(stateSize); // nodes to visit per state bit
+    std::unordered_map<BDD_ID, size_t> queued;                         // node -> position in its level
+
+    for (size_t block = 0; block < states.rows; block += 64) {
+        const size_t count = std::min<size_t>(64, states.rows - block);
+
+        // Transpose the block into bit slices
+        std::fill(slices.begin(), slices.end(), 0);
+        for (size_t r = 0; r < count; ++r) {
+            const uint64_t *row = &states.words[(block + r) * states.wordsPerRow()];
+            for (unsigned int i = 0; i < stateSize; ++i) {
+                slices[i] |= (row[i / 64] >> (i % 64) & 1) << r;
+            }
+        }
+
+        // Push the row masks from the root down, level by level
+        uint64_t accepted = 0;
+        auto visit = [&](const BDD_ID f, const uint64_t mask) {
+            if (mask == 0 || f == Manager::False()) {
+                return;
+            }
+            if (f == Manager::True()) {
+                accepted |= mask;
+                return;
+            }
+            auto &level = levels[stateIndex.at(topVar(f))];
+            const auto entry = queued.emplace(f, level.size());
+            if (entry.second) {
+                level.emplace_back(f, mask);
+            } else {
+                level[entry.first->second].second |= mask;
+            }
+        };
+        visit(stateSet, count == 64 ? ~uint64_t{0} : (uint64_t{1} << count) - 1);
+        for (unsigned int i = 0; i < stateSize; ++i) {
+            for (size_t k = 0; k < levels[i].size(); ++k) {
+                const auto [f, mask] = levels[i][k];
+                visit(coFactorTrue(f), mask & slices[i]);
+                visit(coFactorFalse(f), mask & ~slices[i]);
+            }
+            levels[i].clear();
+        }
+        queued.clear();
+
+        for (size_t r = 0; r < count; ++r) {
+            contained[block + r] = (accepted >> r & 1) != 0;
         }
     }
-    return false;
+    return contained;
 }
 
 // Iteratively computes the set of reachable states until a fixed point is reached.
 void Reachability::computeReachableStates() {
-    BDD_ID tau = computeTransitionRelation();
-    BDD_ID Crit = initialStates;
-    BDD_ID img, Cr;
+    // After a behaviour-preserving update, the old reachable set is a subset of the new one that contains
+    // the initial states, so the traversal can start from it.
+    const BDD start = seedStates.manager() != nullptr ? seedStates : initialStates;
+    seedStates = BDD();
 
-    // Loop until no new reachable states are found.
-    do {
-        Cr = Crit;
-        img = computeImage(Cr, tau);
-        Crit = or2(img, Cr);
-    } while (Cr != Crit);
+    if (traversalMode == TraversalMode::Saturation) {
+        // Saturation fires event relations instead of whole images
+        const std::vector<std::vector<SaturationEvent>> events = buildSaturationEvents();
+        reachableStates = saturate(start, events, events.size());
+        reachableValid = true;
+        return;
+    }
+
+    const TransitionRelation &tau = transitionRelation();
+    const BDD none(*this, Manager::False());
+    // A threshold of zero disables the approximation
+    auto under = [&](const BDD &f) {
+        return approxThreshold == 0 ? f : BDD(*this, underApprox(f.id(), approxThreshold, approxMethod));
+    };
+    auto over = [&](const BDD &f) {
+        return approxThreshold == 0 ? f : BDD(*this, overApprox(f.id(), approxThreshold, approxMethod));
+    };
+    BDD Crit = start;
+    BDD Cr;
+
+    switch (traversalMode) {
+        case TraversalMode::HighDensity: {
+            // Image only a dense subset of the new states. Once that yields nothing new, the image of
+            // the full set decides whether the fixed point is reached.
+            Cr = start;
+            BDD from = under(Cr);
+            beginTraversal(SearchDirection::Forward);
+            while (true) {
+                BDD fresh = computeImage(from, tau) & ~Cr;
+                if (fresh == none) {
+                    fresh = computeImage(Cr, tau) & ~Cr;
+                    if (fresh == none) {
+                        endIteration(from, Cr);
+                        break;
+                    }
+                }
+                Cr |= fresh;
+                endIteration(from, Cr);
+                from = under(fresh);
+            }
+            break;
+        }
+        case TraversalMode::Frontier: {
+            // Image only the states discovered in the previous iteration
+            Cr = start;
+            BDD from = Cr;
+            beginTraversal(SearchDirection::Forward);
+            while (true) {
+                const BDD fresh = computeImage(from, tau) & ~Cr;
+                if (fresh == none) {
+                    endIteration(from, Cr);
+                    break;
+                }
+                BDD next = nextFrontier(fresh, Cr);
+                Cr |= fresh;
+                endIteration(from, Cr);
+                from = std::move(next);
+            }
+            break;
+        }
+        case TraversalMode::OverApproximate:
+            // Keep the old iterate in the new one, so the sequence grows monotonically and terminates
+            beginTraversal(SearchDirection::Forward);
+            do {
+                Cr = Crit;
+                Crit = over(computeImage(Cr, tau) | Cr) | Cr;
+                endIteration(Cr, Crit);
+            } while (Cr != Crit);
+            break;
+        default:
+            // Loop until no new reachable states are found.
+            beginTraversal(SearchDirection::Forward);
+            do {
+                Cr = Crit;
+                Crit = computeImage(Cr, tau) | Cr;
+                endIteration(Cr, Crit);
+            } while (Cr != Crit);
+    }
 
     reachableStates = Cr;
+    reachableValid = true;
 }
 
 int Reachability::stateDistance(const std::vector<bool> &stateVector) {
     if (stateVector.size() != stateSize) {
         throw std::runtime_error("State vector size mismatch with state size.");
     }
-    int cnt = 0;
-    BDD_ID tau = computeTransitionRelation();
-    BDD_ID Crit = initialStates;
-    BDD_ID img, Cr;
-    
-    // Loop until the target state is found or no new states are reached.
-    do {
-        Cr = Crit;
-        img = computeImage(Cr, tau);
-        // Unification of the reachable states
-        Crit = or2(img, Cr);
-        if (isReachableInSet(stateVector, Cr)) {
-            return cnt;
-        }
-        cnt++;
-    } while (Cr != Crit);
+    // The rings are computed once, then the distance is the index of the ring holding the state.
+    if (rings.empty()) {
+        computeRings();
+    }
+    for (size_t k = 0; k < rings.size(); ++k) {
+        if (isReachableInSet(stateVector, rings[k])) {
+            return static_cast<int>(k);
+        }
+    }
     return -1; // Return -1 if target state is unreachable.
 }
 
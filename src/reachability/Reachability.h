@@ -2,34 +2,212 @@
 #define VDSPROJECT_REACHABILITY_H
 
 #include "ReachabilityInterface.h"
+#include "ImagePool.h"
+#include "../BDD.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
 
 namespace ClassProject {
 
+// Traversal strategy of Reachability::computeReachableStates
+enum class TraversalMode {
+    Exact,           // image of the full reachable set in every iteration
+    Frontier,        // image of the states discovered in the previous iteration only
+    HighDensity,     // image of a dense under-approximation of the new states, closed by an exact check
+    OverApproximate, // every iterate is over-approximated, yields a superset of the reachable states
+    Saturation       // fire event relations bottom-up by level until every level is saturated
+};
+
+// Representation of the transition relation used for image computation
+enum class ImageMethod {
+    Monolithic,  // one BDD for the whole relation
+    Partitioned  // clusters of per-bit relations, conjoined with early quantification
+};
+
+// Packed bit matrix of state vectors, one state per row. Rows are stored one after another in
+// (bits + 63) / 64 words each, bit i of a row is bit i % 64 of its word i / 64.
+struct StateMatrix {
+    size_t rows;
+    size_t bits;
+    std::vector<uint64_t> words;
+
+    StateMatrix(const size_t rows, const size_t bits) : rows(rows), bits(bits), words(rows * wordsPerRow(), 0) {}
+
+    size_t wordsPerRow() const
+    {
+        return (bits + 63) / 64;
+    }
+
+    bool get(const size_t row, const size_t bit) const
+    {
+        return (words[row * wordsPerRow() + bit / 64] >> (bit % 64) & 1) != 0;
+    }
+
+    void set(const size_t row, const size_t bit, const bool value)
+    {
+        uint64_t &word = words[row * wordsPerRow() + bit / 64];
+        const uint64_t mask = uint64_t{1} << (bit % 64);
+        word = value ? (word | mask) : (word & ~mask);
+    }
+};
+
+// Shortest path from the initial states to a target state, see Reachability::shortestTrace
+struct Trace {
+    std::vector<std::vector<bool>> states; // states[0] is an initial state, states.back() the target
+    std::vector<std::vector<bool>> inputs; // inputs[k] leads from states[k] to states[k + 1]
+};
+
+// Outcome of Reachability::checkInvariant
+struct InvariantResult {
+    bool holds = true;           // no bad state is reachable
+    int depth = -1;              // distance of the nearest reachable bad state, -1 if the invariant holds
+    std::vector<bool> witness;   // a reachable bad state at that distance, empty if the invariant holds
+};
+
+// Direction of Reachability::distanceTo
+enum class SearchDirection {
+    Forward,       // images from the initial states until the target is hit
+    Backward,      // preimages from the target until an initial state is hit
+    Bidirectional  // grows the smaller of both frontiers until they intersect
+};
+
+// Telemetry of one fixpoint iteration, see Reachability::setIterationCallback
+struct IterationStats {
+    SearchDirection direction = SearchDirection::Forward; // images (Forward) or preimages (Backward)
+    size_t iteration = 0;         // 1 for the first image step of a traversal
+    size_t frontierNodes = 0;     // nodes of the set imaged in this iteration
+    size_t reachedNodes = 0;      // nodes of the reached set after this iteration
+    double imageSeconds = 0;      // wall time of the image computations of this iteration
+    double quantifySeconds = 0;   // part of imageSeconds spent conjoining and quantifying (before renaming)
+    size_t peakNodes = 0;         // largest manager size so far, sampled after every image unless the
+                                  // Manager counters are compiled in
+    double computedHitRate = -1;  // computed table hits per lookup in this iteration, -1 without VDS_MANAGER_STATS
+};
+
 // The Reachability class implements state reachability analysis using Binary Decision Diagrams (BDD).
 // It extends ReachabilityInterface and provides methods to compute reachable states and distances.
 class Reachability : public ReachabilityInterface {
 private:
+    // Conjunctively partitioned transition relation with its early quantification schedule
+    struct TransitionRelation {
+        BDD quantifyFirst;         // cube of the variables no cluster depends on
+        std::vector<BDD> clusters; // conjoined in this order
+        std::vector<BDD> quantify; // cube of the variables to quantify right after each cluster
+        std::vector<std::vector<unsigned int>> members; // state bits whose partitions form each cluster
+    };
+
+    // Local relation of a saturation event. The state bits outside changes keep their value, the relation
+    // neither mentions their next state bits nor constrains them to be unchanged.
+    struct SaturationEvent {
+        BDD relation; // over the next state bits in changes and the state bits the event depends on
+        BDD changes;  // cube of the state bits the event may change
+    };
+
     unsigned int stateSize;
     unsigned int inputSize;
     
     std::vector<BDD_ID> stateBits;
     std::vector<BDD_ID> nextStateBits;
     std::vector<BDD_ID> inputBits;
-    std::vector<BDD_ID> transitionFunctions;
+    // Maps every next state bit to its state bit
+    std::unordered_map<BDD_ID, BDD_ID> nextToCurrent;
+    // nextToCurrent, plus every state bit mapped to itself (renames the successors of a saturation event)
+    std::unordered_map<BDD_ID, BDD_ID> eventRename;
+    // Maps every state bit to its position in a state vector
+    std::unordered_map<BDD_ID, unsigned int> stateIndex;
+    // Maps every input bit to its position in an input vector
+    std::unordered_map<BDD_ID, unsigned int> inputIndex;
+    // Functions and state sets are held by handles, so garbageCollect() keeps them alive
+    std::vector<BDD> transitionFunctions;
+
+    BDD initialStates;
+    BDD reachableStates;
+
+    // Cached results. The relation is dropped by the setters it depends on, the reachable set and the
+    // onion rings (rings[k] holds the states at distance k) by setTransitionFunctions and setInitState.
+    TransitionRelation relation;
+    bool relationValid = false;
+    bool reachableValid = false;
+    std::vector<BDD> rings;
+    // Reachable subset to start the next traversal from, left by updateTransitionFunctions
+    BDD seedStates;
+
+    // Evaluation order used for the large conjunctions of the transition relation
+    ApplyMode relationApplyMode = ApplyMode::DepthFirst;
+
+    // Traversal strategy and the node threshold of its approximations
+    TraversalMode traversalMode = TraversalMode::Exact;
+    ApproxMethod approxMethod = ApproxMethod::HeavyBranch;
+    size_t approxThreshold = 0;
+    // Minimize each frontier with restrict against the states reached before it
+    bool frontierRestrict = false;
 
-    BDD_ID initialStates;
-    BDD_ID reachableStates;
+    // Image computation over a partitioned relation, clusters are merged up to this many nodes
+    ImageMethod imageMethod = ImageMethod::Partitioned;
+    size_t clusterThreshold = 1000;
+
+    // Parallel image computation: forks of this manager that share the relation read-only, driven by threads
+    // that wait between the steps. Frontiers below imageMinNodes are imaged sequentially.
+    unsigned int imageThreads = 1;
+    size_t imageMinNodes = 0;
+    std::vector<std::unique_ptr<Manager>> imageWorkers;
+    std::unique_ptr<ImagePool> imagePool;
+
+    // Telemetry. Nothing is measured while no callback is set.
+    std::function<void(const IterationStats &)> iterationCallback;
+    IterationStats iterationStats;  // the iteration in progress
+    ManagerStats iterationCounters; // Manager counters at its start
+
+    // Starts the telemetry of a traversal in the given direction.
+    void beginTraversal(SearchDirection direction);
+    // Completes the current iteration and reports it.
+    void endIteration(const BDD &frontier, const BDD &reached);
 
     // Helper function to compute the next state image based on the current state and transition relation.
-    BDD_ID computeImage(const BDD_ID &currentStates, const BDD_ID &transitionRelation);
+    BDD computeImage(const BDD &currentStates, const TransitionRelation &transitionRelation);
     // Checks if the fixed point in state computation has been reached.
     static bool isFixedPoint(const BDD_ID &current, const BDD_ID &next);
     // Returns a reference to some internal representation (not used in current implementation).
     const BDD_ID &getCR() const;
+    // Returns the cached transition relation, building it on first use.
+    const TransitionRelation &transitionRelation();
+    // Computes the onion rings by a breadth-first traversal, and with them the reachable set.
+    void computeRings();
+    // Picks one assignment of the state and input bits from a non-empty set over them.
+    void pickAssignment(BDD_ID set, std::vector<bool> &state, std::vector<bool> &input);
+    // Drops the cached relation, reachable set and rings.
+    void invalidate(bool keepRelation);
     // Helper to check if a specific state (given as a vector) belongs to a provided state set.
-    bool isReachableInSet(const std::vector<bool> &stateVector, const BDD_ID &stateSet);
+    // Follows one path through the BDD, no nodes are created.
+    bool isReachableInSet(const std::vector<bool> &stateVector, const BDD &stateSet);
+    // Set to image next in frontier traversals: the new states, optionally minimized against the old ones.
+    BDD nextFrontier(const BDD &fresh, const BDD &reached);
     // Computes the overall transition relation based on individual transition functions.
-    BDD_ID computeTransitionRelation();
+    BDD computeTransitionRelation();
+    // Builds the relation for the selected image method: clustered and scheduled, or monolithic.
+    TransitionRelation buildTransitionRelation();
+    // Sets the quantification cubes of a relation from the state and input bits each cluster depends on.
+    void scheduleQuantification(TransitionRelation &relation, const std::vector<std::set<BDD_ID>> &supports);
+    // Transitions of the given state bits out of states, over state and their next state bits, inputs quantified.
+    BDD successorRelation(const BDD &states, const std::set<unsigned int> &bits);
+    // Splits the relation into local events grouped by their top level, deepest level first (saturation).
+    std::vector<std::vector<SaturationEvent>> buildSaturationEvents();
+    // Closes states under the event groups 0 .. groups - 1.
+    BDD saturate(BDD states, const std::vector<std::vector<SaturationEvent>> &events, size_t groups);
+    // Successors of states under one event, the bits outside its changes are kept.
+    BDD fireEvent(const BDD &states, const SaturationEvent &event);
+    // Preimage of a state set, held by handles.
+    BDD computePreimage(const BDD &states);
+    // Image computed by imageThreads workers on disjoint pieces of currentStates, ORed together.
+    BDD computeImageParallel(const BDD &currentStates, const TransitionRelation &transitionRelation);
+    // Image of states within manager, on raw IDs of a relation that manager shares.
+    static BDD_ID imageIn(Manager &manager, BDD_ID states, const TransitionRelation &transitionRelation,
+                          const std::unordered_map<BDD_ID, BDD_ID> &rename);
+    // Conjunction of the given variables.
+    BDD cubeOf(const std::vector<BDD_ID> &vars);
 
 public:
     // Constructor: creates state and input bits, sets up default transition functions and initial state.
@@ -48,11 +226,79 @@ public:
     int stateDistance(const std::vector<bool> &stateVector) override;
     // Sets the transition functions; ensures one per state variable.
     void setTransitionFunctions(const std::vector<BDD_ID> &transitionFunctions) override;
+    // Replaces the transition functions of the given state bits (index -> function). Only the clusters of the
+    // cached relation that contain a changed bit are rebuilt. If every transition out of the old reachable set
+    // still exists, the change only adds behaviour: the old set is then reused as the start of the next
+    // traversal and true is returned. Checking this costs two products of the reachable set with the relations
+    // of the changed bits and of the bits sharing inputs with them.
+    bool updateTransitionFunctions(const std::map<unsigned int, BDD_ID> &changes);
     // Defines the initial state using a boolean vector (false means low, true means high).
     void setInitState(const std::vector<bool> &stateVector) override;
+    // Defines a set of initial states, a BDD over the state bits. A single traversal then covers every initial state.
+    void setInitStates(BDD_ID initialStates);
+
+    // Returns a shortest trace from an initial state to the target, with the inputs of every step. The states
+    // are recovered backwards through the onion rings, one conjunction per step. Empty if the target is unreachable.
+    Trace shortestTrace(const std::vector<bool> &targetState);
+
+    // Checks that no state of badStates is reachable. The traversal stops at the first image step that
+    // hits a bad state, each step is tested with Manager::intersects instead of building the conjunction.
+    InvariantResult checkInvariant(BDD_ID badStates);
+
+    // Returns the states with a successor in states (for some input): exists x. states(delta(s, x)).
+    BDD_ID preimage(BDD_ID states);
+    // Returns all states from which some state of targetStates is reachable, targetStates included.
+    BDD_ID backwardReachableStates(BDD_ID targetStates);
+    // Returns the shortest distance from the initial states to any state of targetStates, -1 if none is reachable.
+    // Bidirectional search stops as soon as the forward and backward sets intersect, the backward cone of
+    // a small target is often tiny compared with the forward state space.
+    int distanceTo(BDD_ID targetStates, SearchDirection direction = SearchDirection::Bidirectional);
+
+    // Returns the set of reachable states, computing it first if needed.
+    BDD_ID getReachableStates();
+    // Number of states in a set over the state bits.
+    double countStates(BDD_ID stateSet);
+
+    // Checks every row of states against the reachable set, see containsStates.
+    std::vector<bool> areReachable(const StateMatrix &states);
+    // Checks every row of states against a set over the state bits. 64 rows are evaluated at once: their
+    // values are transposed into one 64 bit mask per state bit and pushed down the BDD level by level,
+    // so each node is visited once per block of rows and no nodes are created.
+    std::vector<bool> containsStates(const StateMatrix &states, BDD_ID stateSet);
 
     // Computes and stores the set of all reachable states.
     void computeReachableStates();
+
+    // Selects the apply engine for building the transition relation (breadth-first for very large relations).
+    // It covers the monolithic conjunction as well as the cluster merges of the partitioned relation.
+    void setTransitionRelationApplyMode(ApplyMode mode);
+
+    // Selects the image computation. Partitioned keeps one relation per state bit, merges them into clusters of
+    // at most clusterThreshold nodes in an IWLS95 order and quantifies every variable after the last cluster using it.
+    void setImageMethod(ImageMethod method, size_t clusterThreshold = 1000);
+
+    // Computes images on this many threads. The current states are split on the top state bits, each
+    // worker images its pieces in a fork of this manager and the results are transferred back and ORed.
+    // The threads and forks are kept between steps. Every parallel step still copies the pieces into the
+    // forks and the results back, so sets of fewer than minFrontierNodes nodes are imaged sequentially.
+    // An exception of a worker is rethrown by the image step, as in the sequential image.
+    void setImageThreads(unsigned int threads, size_t minFrontierNodes = 256);
+
+    // Calls callback after every iteration of the fixpoint loops: computeReachableStates (except Saturation),
+    // the onion rings, checkInvariant and backwardReachableStates. An empty callback disables the telemetry.
+    void setIterationCallback(std::function<void(const IterationStats &)> callback);
+    // Writes the telemetry to a file, one JSON object per iteration and line.
+    void setIterationTrace(const std::string &fileName);
+
+    // Selects the traversal of computeReachableStates. HighDensity yields the exact reachable set with
+    // smaller intermediate BDDs. With OverApproximate, isReachable returning false is still a proof of
+    // unreachability, but true only means the state may be reachable. A threshold of zero disables the approximation.
+    void setTraversalMode(TraversalMode mode, size_t threshold = 0, ApproxMethod method = ApproxMethod::HeavyBranch);
+    // Number of saturation events per level, index k for the events whose topmost changed or read bit is state bit k.
+    std::vector<size_t> saturationEventCounts();
+    // In Frontier mode, replace each frontier by restrict(frontier, !reached) if that is smaller. Any set between
+    // the frontier and the reached states has the same new successors.
+    void setFrontierRestrict(bool enabled);
 };
 
 } // namespace ClassProject
@@ -2,7 +2,9 @@
 #define VDSPROJECT_REACHABILITY_TESTS_H
 
 #include <gtest/gtest.h>
+#include <fstream>
 #include "Reachability.h"
+#include "CircuitToReachability.hpp"
 
 using namespace ClassProject;
 
@@ -361,4 +363,637 @@ TEST(Distance_Test, distanceExample) { /* NOLINT */
 
 
 
+TEST_F(ReachabilityTest, BreadthFirstRelationTest) { /* NOLINT */
+    auto bfs = std::make_unique<ClassProject::Reachability>(2);
+    auto states = bfs->getStates();
+    bfs->setTransitionRelationApplyMode(ApplyMode::BreadthFirst);
+    bfs->setTransitionFunctions({bfs->neg(states.at(1)), states.at(0)});
+    bfs->setInitState({false, false});
+
+    EXPECT_TRUE(bfs->isReachable({true, true}));
+    EXPECT_EQ(bfs->stateDistance({false, false}), 0);
+    EXPECT_EQ(bfs->stateDistance({true, false}), 1);
+    EXPECT_EQ(bfs->stateDistance({true, true}), 2);
+    EXPECT_EQ(bfs->stateDistance({false, true}), 3);
+
+    // the cluster merges of the partitioned relation follow the mode too
+    auto build = [](ClassProject::Reachability &r) {
+        const auto s = r.getStates();
+        r.setTransitionFunctions({r.neg(s.at(3)), s.at(0), r.xor2(s.at(1), s.at(2)), r.and2(s.at(2), s.at(0))});
+        r.setInitState({false, false, false, false});
+    };
+    ClassProject::Reachability depthFirst(4), breadthFirst(4);
+    build(depthFirst);
+    build(breadthFirst);
+    depthFirst.setImageMethod(ImageMethod::Partitioned, 12);
+    breadthFirst.setImageMethod(ImageMethod::Partitioned, 12);
+    breadthFirst.setTransitionRelationApplyMode(ApplyMode::BreadthFirst);
+    for (unsigned int state = 0; state < 16; ++state) {
+        std::vector<bool> bits;
+        for (unsigned int k = 0; k < 4; ++k) {
+            bits.push_back((state >> k & 1) != 0);
+        }
+        EXPECT_EQ(breadthFirst.stateDistance(bits), depthFirst.stateDistance(bits));
+    }
+}
+
+TEST_F(ReachabilityTest, ApproximateTraversalTest) { /* NOLINT */
+    // 4 bit counter that may skip a step when x0 is set
+    auto exact = std::make_unique<ClassProject::Reachability>(4, 1);
+    auto build = [](ClassProject::Reachability &r) {
+        const auto s = r.getStates();
+        const BDD_ID x = r.getInputs().at(0);
+        const BDD_ID carry0 = r.or2(s[0], x);
+        const BDD_ID carry1 = r.and2(s[1], carry0);
+        r.setTransitionFunctions({r.xor2(s[0], r.neg(x)), r.xor2(s[1], carry0), r.xor2(s[2], carry1),
+                                  r.or2(s[3], r.and2(s[2], carry1))});
+        r.setInitState({false, false, false, false});
+    };
+    build(*exact);
+
+    for (const ApproxMethod method : {ApproxMethod::HeavyBranch, ApproxMethod::ShortPath, ApproxMethod::Remap}) {
+        auto dense = std::make_unique<ClassProject::Reachability>(4, 1);
+        build(*dense);
+        dense->setTraversalMode(TraversalMode::HighDensity, 4, method);
+        auto over = std::make_unique<ClassProject::Reachability>(4, 1);
+        build(*over);
+        over->setTraversalMode(TraversalMode::OverApproximate, 3, method);
+
+        for (unsigned int state = 0; state < 16; ++state) {
+            const std::vector<bool> bits = {(state & 1) != 0, (state & 2) != 0, (state & 4) != 0, (state & 8) != 0};
+            const bool reachable = exact->isReachable(bits);
+            EXPECT_EQ(dense->isReachable(bits), reachable);
+            if (reachable) {
+                EXPECT_TRUE(over->isReachable(bits));
+            }
+        }
+    }
+}
+
+TEST_F(ReachabilityTest, FrontierTraversalTest) { /* NOLINT */
+    // 5 bit counter: 32 iterations with one new state each
+    auto build = [](ClassProject::Reachability &r) {
+        const auto s = r.getStates();
+        std::vector<BDD_ID> next;
+        BDD_ID carry = r.True();
+        for (const BDD_ID bit : s) {
+            next.push_back(r.xor2(bit, carry));
+            carry = r.and2(bit, carry);
+        }
+        r.setTransitionFunctions(next);
+        r.setInitState({true, false, true, false, false});
+    };
+    ClassProject::Reachability exact(5), frontier(5), restricted(5);
+    build(exact);
+    build(frontier);
+    build(restricted);
+    frontier.setTraversalMode(TraversalMode::Frontier);
+    restricted.setTraversalMode(TraversalMode::Frontier);
+    restricted.setFrontierRestrict(true);
+
+    for (unsigned int state = 0; state < 32; ++state) {
+        std::vector<bool> bits;
+        for (unsigned int k = 0; k < 5; ++k) {
+            bits.push_back((state >> k & 1) != 0);
+        }
+        const int distance = static_cast<int>((state + 32 - 5) % 32);
+        EXPECT_EQ(exact.stateDistance(bits), distance);
+        EXPECT_EQ(frontier.stateDistance(bits), distance);
+        EXPECT_EQ(restricted.stateDistance(bits), distance);
+        EXPECT_TRUE(frontier.isReachable(bits));
+        EXPECT_TRUE(restricted.isReachable(bits));
+    }
+
+    // unreachable states stay unreachable
+    ClassProject::Reachability stuck(2);
+    stuck.setTransitionFunctions({stuck.getStates().at(1), stuck.getStates().at(0)});
+    stuck.setInitState({true, false});
+    stuck.setTraversalMode(TraversalMode::Frontier);
+    stuck.setFrontierRestrict(true);
+    EXPECT_TRUE(stuck.isReachable({false, true}));
+    EXPECT_FALSE(stuck.isReachable({true, true}));
+    EXPECT_EQ(stuck.stateDistance({false, true}), 1);
+    EXPECT_EQ(stuck.stateDistance({false, false}), -1);
+}
+
+TEST_F(ReachabilityTest, PartitionedImageTest) { /* NOLINT */
+    // shift register with an input and feedback, image results must not depend on the relation layout
+    auto build = [](ClassProject::Reachability &r) {
+        const auto s = r.getStates();
+        const auto x = r.getInputs();
+        r.setTransitionFunctions({r.xor2(x.at(0), s.at(5)), s.at(0), r.and2(s.at(1), x.at(1)), r.or2(s.at(2), s.at(0)),
+                                  s.at(3), r.xor2(s.at(4), s.at(2))});
+        r.setInitState({false, false, false, false, false, false});
+    };
+    ClassProject::Reachability monolithic(6, 2), partitioned(6, 2), clustered(6, 2);
+    build(monolithic);
+    build(partitioned);
+    build(clustered);
+    monolithic.setImageMethod(ImageMethod::Monolithic);
+    partitioned.setImageMethod(ImageMethod::Partitioned, 0);
+    clustered.setImageMethod(ImageMethod::Partitioned, 12);
+
+    for (unsigned int state = 0; state < 64; ++state) {
+        std::vector<bool> bits;
+        for (unsigned int k = 0; k < 6; ++k) {
+            bits.push_back((state >> k & 1) != 0);
+        }
+        const int distance = monolithic.stateDistance(bits);
+        EXPECT_EQ(partitioned.stateDistance(bits), distance);
+        EXPECT_EQ(clustered.stateDistance(bits), distance);
+        EXPECT_EQ(clustered.isReachable(bits), distance >= 0);
+    }
+}
+
+TEST_F(ReachabilityTest, SaturationTest) { /* NOLINT */
+    // loosely coupled: two 3 bit counters stepping on their own input, plus a flag that latches when both
+    // are full and stops them
+    auto build = [](ClassProject::Reachability &r) {
+        const auto s = r.getStates();
+        const auto x = r.getInputs();
+        std::vector<BDD_ID> next;
+        for (unsigned int c = 0; c < 2; ++c) {
+            BDD_ID carry = r.and2(x.at(c), r.neg(s.at(6)));
+            for (unsigned int k = 0; k < 3; ++k) {
+                next.push_back(r.xor2(s.at(3 * c + k), carry));
+                carry = r.and2(s.at(3 * c + k), carry);
+            }
+        }
+        BDD_ID full = r.True();
+        for (unsigned int k = 0; k < 6; ++k) {
+            full = r.and2(full, s.at(k));
+        }
+        next.push_back(r.or2(s.at(6), full));
+        r.setTransitionFunctions(next);
+        r.setInitState({false, true, false, false, false, false, false});
+    };
+    ClassProject::Reachability exact(7, 2), saturation(7, 2);
+    build(exact);
+    build(saturation);
+    saturation.setTraversalMode(TraversalMode::Saturation);
+
+    unsigned int reachable = 0;
+    for (unsigned int state = 0; state < 128; ++state) {
+        std::vector<bool> bits;
+        for (unsigned int k = 0; k < 7; ++k) {
+            bits.push_back((state >> k & 1) != 0);
+        }
+        EXPECT_EQ(saturation.isReachable(bits), exact.isReachable(bits));
+        reachable += exact.isReachable(bits);
+    }
+    EXPECT_EQ(reachable, 68);
+
+    // the default 2 bit FSM from the fixture
+    ClassProject::Reachability twoBit(2);
+    twoBit.setTransitionFunctions({twoBit.neg(twoBit.getStates().at(1)), twoBit.getStates().at(0)});
+    twoBit.setTraversalMode(TraversalMode::Saturation);
+    EXPECT_TRUE(twoBit.isReachable({true, true}));
+    EXPECT_TRUE(twoBit.isReachable({false, true}));
+
+    // without the flag the counters are independent: the events of the second counter neither read nor
+    // change the first one and sit at its top bit
+    ClassProject::Reachability counters(6, 2);
+    auto buildCounters = [](ClassProject::Reachability &r) {
+        const auto s = r.getStates();
+        const auto x = r.getInputs();
+        std::vector<BDD_ID> next;
+        for (unsigned int c = 0; c < 2; ++c) {
+            BDD_ID carry = x.at(c);
+            for (unsigned int k = 0; k < 3; ++k) {
+                next.push_back(r.xor2(s.at(3 * c + k), carry));
+                carry = r.and2(s.at(3 * c + k), carry);
+            }
+        }
+        r.setTransitionFunctions(next);
+        r.setInitState({false, false, false, false, false, false});
+    };
+    buildCounters(counters);
+    counters.setTraversalMode(TraversalMode::Saturation);
+    // counting always flips the low bit, so each counter has one event
+    EXPECT_EQ(counters.saturationEventCounts(), (std::vector<size_t>{1, 0, 0, 1, 0, 0}));
+    EXPECT_EQ(counters.countStates(counters.getReachableStates()), 64.0);
+}
+
+TEST_F(ReachabilityTest, CachedQueriesTest) { /* NOLINT */
+    ClassProject::Reachability counter(4);
+    const auto s = counter.getStates();
+    BDD_ID carry = counter.True();
+    std::vector<BDD_ID> next;
+    for (const BDD_ID bit : s) {
+        next.push_back(counter.xor2(bit, carry));
+        carry = counter.and2(bit, carry);
+    }
+    counter.setTransitionFunctions(next);
+    EXPECT_EQ(counter.stateDistance({true, true, true, true}), 15);
+    EXPECT_TRUE(counter.isReachable({false, true, false, true}));
+
+    // answered from the cached set and rings, without touching the unique table
+    const size_t size = counter.uniqueTableSize();
+    for (unsigned int state = 0; state < 16; ++state) {
+        const std::vector<bool> bits = {(state & 1) != 0, (state & 2) != 0, (state & 4) != 0, (state & 8) != 0};
+        EXPECT_TRUE(counter.isReachable(bits));
+        EXPECT_EQ(counter.stateDistance(bits), static_cast<int>(state));
+    }
+    EXPECT_EQ(counter.uniqueTableSize(), size);
+
+    // the setters invalidate the cache
+    counter.setInitState({false, true, false, false});
+    EXPECT_EQ(counter.stateDistance({false, true, false, false}), 0);
+    EXPECT_EQ(counter.stateDistance({false, false, false, false}), 14);
+    counter.setTransitionFunctions(s);
+    EXPECT_FALSE(counter.isReachable({false, false, false, false}));
+    EXPECT_EQ(counter.stateDistance({true, true, false, false}), -1);
+}
+
+TEST_F(ReachabilityTest, BatchMembershipTest) { /* NOLINT */
+    // 7 bit counter from 0 that stops at 99
+    ClassProject::Reachability counter(7);
+    const auto s = counter.getStates();
+    BDD_ID at_stop = counter.True();
+    for (unsigned int k = 0; k < 7; ++k) {
+        at_stop = counter.and2(at_stop, (99 >> k & 1) ? s[k] : counter.neg(s[k]));
+    }
+    BDD_ID carry = counter.neg(at_stop);
+    std::vector<BDD_ID> next;
+    for (const BDD_ID bit : s) {
+        next.push_back(counter.xor2(bit, carry));
+        carry = counter.and2(bit, carry);
+    }
+    counter.setTransitionFunctions(next);
+
+    // more rows than one block, with a partial last block
+    StateMatrix states(300, 7);
+    for (size_t row = 0; row < states.rows; ++row) {
+        for (unsigned int k = 0; k < 7; ++k) {
+            states.set(row, k, ((row * 37 % 128) >> k & 1) != 0);
+        }
+    }
+    const std::vector<bool> reachable = counter.areReachable(states);
+    ASSERT_EQ(reachable.size(), states.rows);
+    for (size_t row = 0; row < states.rows; ++row) {
+        std::vector<bool> bits;
+        for (unsigned int k = 0; k < 7; ++k) {
+            bits.push_back(states.get(row, k));
+        }
+        EXPECT_EQ(reachable[row], counter.isReachable(bits));
+        EXPECT_EQ(reachable[row], row * 37 % 128 <= 99);
+    }
+
+    // any state set, no nodes are created
+    const size_t built = counter.uniqueTableSize();
+    const std::vector<bool> odd = counter.containsStates(states, s[0]);
+    for (size_t row = 0; row < states.rows; ++row) {
+        EXPECT_EQ(odd[row], row * 37 % 2 == 1);
+    }
+    EXPECT_EQ(counter.uniqueTableSize(), built);
+    EXPECT_EQ(counter.containsStates(StateMatrix(0, 7), counter.True()).size(), 0);
+    EXPECT_THROW(counter.containsStates(StateMatrix(1, 6), counter.True()), std::runtime_error);
+}
+
+TEST_F(ReachabilityTest, ShortestTraceTest) { /* NOLINT */
+    // 4 bit register: x0 loads the shifted value with a one, otherwise it is cleared
+    ClassProject::Reachability shift(4, 1);
+    const auto s = shift.getStates();
+    const BDD_ID x = shift.getInputs().at(0);
+    shift.setTransitionFunctions({x, shift.and2(x, s[0]), shift.and2(x, s[1]), shift.and2(x, s[2])});
+
+    const Trace trace = shift.shortestTrace({true, true, true, false});
+    ASSERT_EQ(trace.states.size(), 4);
+    ASSERT_EQ(trace.inputs.size(), 3);
+    EXPECT_EQ(trace.states[0], std::vector<bool>({false, false, false, false}));
+    EXPECT_EQ(trace.states[1], std::vector<bool>({true, false, false, false}));
+    EXPECT_EQ(trace.states[2], std::vector<bool>({true, true, false, false}));
+    EXPECT_EQ(trace.states[3], std::vector<bool>({true, true, true, false}));
+    for (const auto &input : trace.inputs) {
+        EXPECT_EQ(input, std::vector<bool>({true}));
+    }
+
+    const Trace initial = shift.shortestTrace({false, false, false, false});
+    ASSERT_EQ(initial.states.size(), 1);
+    EXPECT_TRUE(initial.inputs.empty());
+
+    EXPECT_TRUE(shift.shortestTrace({false, true, false, false}).states.empty());
+    EXPECT_THROW(shift.shortestTrace({true}), std::runtime_error);
+}
+
+TEST_F(ReachabilityTest, BackwardSearchTest) { /* NOLINT */
+    // 5 bit counter with reset input
+    ClassProject::Reachability counter(5, 1);
+    const auto s = counter.getStates();
+    const BDD_ID reset = counter.getInputs().at(0);
+    BDD_ID carry = counter.True();
+    std::vector<BDD_ID> next;
+    for (const BDD_ID bit : s) {
+        next.push_back(counter.and2(counter.neg(reset), counter.xor2(bit, carry)));
+        carry = counter.and2(bit, carry);
+    }
+    counter.setTransitionFunctions(next);
+    counter.setInitState({false, true, false, false, false});
+
+    auto state = [&](const unsigned int value) {
+        BDD_ID cube = counter.True();
+        for (unsigned int k = 0; k < 5; ++k) {
+            cube = counter.and2(cube, (value >> k & 1) ? s[k] : counter.neg(s[k]));
+        }
+        return cube;
+    };
+
+    // predecessors of 5: 4 by counting, every state by reset if 5 were 0
+    EXPECT_EQ(counter.preimage(state(5)), state(4));
+    EXPECT_EQ(counter.preimage(state(0)), counter.True());
+    EXPECT_EQ(counter.backwardReachableStates(state(3)), counter.True());
+
+    for (const unsigned int value : {2u, 3u, 0u, 1u, 17u, 31u}) {
+        const int distance = static_cast<int>(value >= 2 ? value - 2 : value + 1);
+        EXPECT_EQ(counter.distanceTo(state(value), SearchDirection::Forward), distance);
+        EXPECT_EQ(counter.distanceTo(state(value), SearchDirection::Backward), distance);
+        EXPECT_EQ(counter.distanceTo(state(value), SearchDirection::Bidirectional), distance);
+    }
+    EXPECT_EQ(counter.distanceTo(counter.or2(state(9), state(30))), 7);
+
+    // without the reset 0 and 1 become unreachable, searches in both directions stop on their own
+    ClassProject::Reachability free(3);
+    const auto f = free.getStates();
+    free.setTransitionFunctions({free.neg(f[0]), free.xor2(f[1], f[0]), f[2]});
+    free.setInitState({false, false, true});
+    const BDD_ID low_half = free.neg(f[2]);
+    EXPECT_EQ(free.distanceTo(low_half, SearchDirection::Forward), -1);
+    EXPECT_EQ(free.distanceTo(low_half, SearchDirection::Backward), -1);
+    EXPECT_EQ(free.distanceTo(low_half, SearchDirection::Bidirectional), -1);
+    EXPECT_EQ(free.backwardReachableStates(low_half), low_half);
+    EXPECT_EQ(free.distanceTo(free.and2(f[2], f[1])), 2);
+}
+
+TEST_F(ReachabilityTest, CheckInvariantTest) { /* NOLINT */
+    // 4 bit counter from 3 that wraps at 12
+    ClassProject::Reachability counter(4);
+    const auto s = counter.getStates();
+    const BDD_ID at_wrap = counter.and2(counter.and2(s[2], s[3]), counter.nor2(s[0], s[1]));
+    BDD_ID carry = counter.True();
+    std::vector<BDD_ID> next;
+    for (const BDD_ID bit : s) {
+        next.push_back(counter.and2(counter.neg(at_wrap), counter.xor2(bit, carry)));
+        carry = counter.and2(bit, carry);
+    }
+    counter.setTransitionFunctions(next);
+    counter.setInitState({true, true, false, false});
+
+    // above 12 is never reached, 7 or 9 first at depth 4
+    const InvariantResult safe = counter.checkInvariant(counter.and2(counter.and2(s[3], s[2]), counter.or2(s[0], s[1])));
+    EXPECT_TRUE(safe.holds);
+    EXPECT_EQ(safe.depth, -1);
+    EXPECT_TRUE(safe.witness.empty());
+
+    const BDD_ID seven = counter.and2(counter.and2(s[0], s[1]), counter.and2(s[2], counter.neg(s[3])));
+    const BDD_ID nine = counter.and2(counter.and2(s[0], counter.neg(s[1])), counter.and2(counter.neg(s[2]), s[3]));
+    const InvariantResult broken = counter.checkInvariant(counter.or2(seven, nine));
+    EXPECT_FALSE(broken.holds);
+    EXPECT_EQ(broken.depth, 4);
+    EXPECT_EQ(broken.witness, std::vector<bool>({true, true, true, false}));
+
+    // the same answers from the cached rings
+    EXPECT_EQ(counter.stateDistance({false, false, false, false}), 10);
+    const InvariantResult cached = counter.checkInvariant(counter.or2(seven, nine));
+    EXPECT_EQ(cached.depth, 4);
+    EXPECT_EQ(cached.witness, broken.witness);
+    EXPECT_EQ(counter.checkInvariant(counter.True()).depth, 0);
+}
+
+TEST_F(ReachabilityTest, ParallelImageTest) { /* NOLINT */
+    // same shift register as above, threaded images (also more threads than split pieces) match the sequential
+    auto build = [](ClassProject::Reachability &r) {
+        const auto s = r.getStates();
+        const auto x = r.getInputs();
+        r.setTransitionFunctions({r.xor2(x.at(0), s.at(5)), s.at(0), r.and2(s.at(1), x.at(1)), r.or2(s.at(2), s.at(0)),
+                                  s.at(3), r.xor2(s.at(4), s.at(2))});
+        r.setInitState({false, false, false, false, false, false});
+    };
+    ClassProject::Reachability sequential(6, 2), two(6, 2), three(6, 2);
+    build(sequential);
+    build(two);
+    build(three);
+    two.setImageThreads(2, 0);
+    three.setImageThreads(3, 0);
+    three.setImageMethod(ImageMethod::Partitioned, 12);
+
+    for (unsigned int state = 0; state < 64; ++state) {
+        std::vector<bool> bits;
+        for (unsigned int k = 0; k < 6; ++k) {
+            bits.push_back((state >> k & 1) != 0);
+        }
+        const int distance = sequential.stateDistance(bits);
+        EXPECT_EQ(two.stateDistance(bits), distance);
+        EXPECT_EQ(three.stateDistance(bits), distance);
+        EXPECT_EQ(three.isReachable(bits), distance >= 0);
+    }
+
+    // the workers are rebuilt after the transition functions change
+    const auto s = two.getStates();
+    two.setTransitionFunctions({s.at(1), s.at(2), s.at(3), s.at(4), s.at(5), two.neg(s.at(0))});
+    EXPECT_EQ(two.stateDistance({true, true, true, true, true, true}), 6);
+    EXPECT_FALSE(two.isReachable({true, false, true, false, false, false}));
+
+    // frontiers below the threshold are imaged sequentially, larger ones by the threads
+    ClassProject::Reachability gated(6, 2);
+    build(gated);
+    gated.setImageThreads(2, 6);
+    for (unsigned int state = 0; state < 64; ++state) {
+        std::vector<bool> bits;
+        for (unsigned int k = 0; k < 6; ++k) {
+            bits.push_back((state >> k & 1) != 0);
+        }
+        EXPECT_EQ(gated.stateDistance(bits), sequential.stateDistance(bits));
+    }
+}
+
+TEST_F(ReachabilityTest, CountStatesTest) { /* NOLINT */
+    // s0 toggles, s1 is set only from 11: from 00 only 00 and 10 are reachable (s0 first)
+    ClassProject::Reachability r(2);
+    const auto s = r.getStates();
+    r.setTransitionFunctions({r.neg(s.at(0)), r.and2(s.at(0), s.at(1))});
+
+    EXPECT_EQ(r.countStates(r.getReachableStates()), 2.0);
+    EXPECT_EQ(r.countStates(r.True()), 4.0);
+    EXPECT_EQ(r.countStates(r.False()), 0.0);
+    EXPECT_EQ(r.countStates(s.at(1)), 2.0);
+}
+
+TEST_F(ReachabilityTest, IterationTelemetryTest) { /* NOLINT */
+    // 3 bit counter: 7 growing images and one that finds nothing new, in both directions
+    ClassProject::Reachability r(3);
+    const auto s = r.getStates();
+    r.setTransitionFunctions({r.neg(s.at(0)), r.xor2(s.at(1), s.at(0)), r.xor2(s.at(2), r.and2(s.at(1), s.at(0)))});
+    r.setTraversalMode(TraversalMode::Frontier);
+
+    std::vector<IterationStats> log;
+    r.setIterationCallback([&log](const IterationStats &stats) { log.push_back(stats); });
+    r.computeReachableStates();
+    ASSERT_EQ(log.size(), 8u);
+    for (size_t k = 0; k < log.size(); ++k) {
+        EXPECT_EQ(log[k].direction, SearchDirection::Forward);
+        EXPECT_EQ(log[k].iteration, k + 1);
+        EXPECT_GE(log[k].imageSeconds, log[k].quantifySeconds);
+        EXPECT_GE(log[k].peakNodes, log[k].reachedNodes);
+    }
+    EXPECT_EQ(log.back().reachedNodes, 1u); // all states: the True terminal
+
+    log.clear();
+    const BDD_ID top = r.and2(s.at(0), r.and2(s.at(1), s.at(2)));
+    r.backwardReachableStates(top);
+    ASSERT_EQ(log.size(), 8u);
+    EXPECT_EQ(log.front().direction, SearchDirection::Backward);
+
+    // disabled: nothing is reported
+    log.clear();
+    r.setIterationCallback(nullptr);
+    r.setInitState({false, false, false});
+    r.computeReachableStates();
+    EXPECT_TRUE(log.empty());
+
+    // JSON lines, one per iteration
+    const std::string traceFile = "reachability_trace.jsonl";
+    r.setIterationTrace(traceFile);
+    r.setInitState({false, false, false});
+    r.computeReachableStates();
+    r.setIterationCallback(nullptr);
+    std::ifstream trace(traceFile);
+    std::string line;
+    size_t lines = 0;
+    while (std::getline(trace, line)) {
+        EXPECT_EQ(line.front(), '{');
+        EXPECT_NE(line.find("\"iteration\": " + std::to_string(++lines)), std::string::npos);
+    }
+    EXPECT_EQ(lines, 8u);
+    std::remove(traceFile.c_str());
+}
+
+TEST_F(ReachabilityTest, InitialStateSetTest) { /* NOLINT */
+    // two independent toggles that stop at 11: one traversal from {00, 01} equals the union of both runs
+    ClassProject::Reachability r(2);
+    const auto s = r.getStates();
+    const BDD_ID done = r.and2(s.at(0), s.at(1));
+    r.setTransitionFunctions({r.or2(r.neg(s.at(0)), done), r.or2(r.neg(s.at(1)), done)});
+
+    r.setInitState({false, false});
+    EXPECT_TRUE(r.isReachable({true, true}));
+    EXPECT_FALSE(r.isReachable({true, false}));
+    r.setInitState({false, true});
+    EXPECT_TRUE(r.isReachable({true, false}));
+    EXPECT_FALSE(r.isReachable({false, false}));
+
+    r.setInitStates(r.neg(s.at(0)));
+    EXPECT_TRUE(r.isReachable({false, false}));
+    EXPECT_TRUE(r.isReachable({false, true}));
+    EXPECT_TRUE(r.isReachable({true, false}));
+    EXPECT_TRUE(r.isReachable({true, true}));
+    EXPECT_EQ(r.stateDistance({false, true}), 0);
+    EXPECT_EQ(r.stateDistance({true, true}), 1);
+
+    EXPECT_THROW(r.setInitStates(r.False()), std::runtime_error);
+    EXPECT_THROW(r.setInitStates(r.getStates().size() + 100000), std::runtime_error);
+    ClassProject::Reachability withInput(1, 1);
+    EXPECT_THROW(withInput.setInitStates(withInput.getInputs().at(0)), std::runtime_error);
+}
+
+TEST_F(ReachabilityTest, IncrementalUpdateTest) { /* NOLINT */
+    // 2 bit counter enabled by x that stops at 3, s2 stays low
+    auto build = [](ClassProject::Reachability &r) {
+        const auto s = r.getStates();
+        const BDD_ID full = r.and2(s.at(0), s.at(1));
+        const BDD_ID enable = r.and2(r.getInputs().at(0), r.neg(full));
+        r.setTransitionFunctions({r.xor2(s.at(0), enable), r.xor2(s.at(1), r.and2(s.at(0), enable)), s.at(2)});
+    };
+    ClassProject::Reachability r(3, 1), clustered(3, 1);
+    build(r);
+    build(clustered);
+    clustered.setImageMethod(ImageMethod::Partitioned, 0);
+    EXPECT_EQ(r.countStates(r.getReachableStates()), 4.0);
+    EXPECT_EQ(clustered.countStates(clustered.getReachableStates()), 4.0);
+
+    // adds behaviour: x in state 3 now also sets s2, every old transition is kept
+    auto setTop = [](ClassProject::Reachability &m) {
+        const auto s = m.getStates();
+        return m.or2(s.at(2), m.and2(m.getInputs().at(0), m.and2(s.at(0), s.at(1))));
+    };
+    size_t iterations = 0;
+    r.setIterationCallback([&iterations](const IterationStats &) { iterations++; });
+    EXPECT_TRUE(r.updateTransitionFunctions({{2, setTop(r)}}));
+    EXPECT_TRUE(clustered.updateTransitionFunctions({{2, setTop(clustered)}}));
+    EXPECT_EQ(r.countStates(r.getReachableStates()), 5.0);
+    EXPECT_EQ(iterations, 2u); // seeded with the 4 old states: one image finds state 7, one confirms
+    EXPECT_TRUE(r.isReachable({true, true, true}));
+    EXPECT_TRUE(clustered.isReachable({true, true, true}));
+    EXPECT_FALSE(clustered.isReachable({false, false, true}));
+    EXPECT_EQ(clustered.stateDistance({true, true, true}), 4);
+
+    // removes behaviour: s0 is frozen, so the old set is dropped
+    EXPECT_FALSE(r.updateTransitionFunctions({{0, r.getStates().at(0)}}));
+    EXPECT_FALSE(clustered.updateTransitionFunctions({{0, clustered.getStates().at(0)}}));
+    EXPECT_EQ(r.countStates(r.getReachableStates()), 1.0);
+    EXPECT_FALSE(clustered.isReachable({true, false, false}));
+    EXPECT_TRUE(clustered.isReachable({false, false, false}));
+
+    EXPECT_THROW(r.updateTransitionFunctions({{3, r.True()}}), std::runtime_error);
+
+    // both bits copy x, so only 00 and 11 are reachable. Inverting x for s0 alone keeps every value of s0
+    // possible, but not together with s1: the check has to include s1, which shares the input.
+    ClassProject::Reachability coupled(2, 1);
+    const BDD_ID x = coupled.getInputs().at(0);
+    coupled.setTransitionFunctions({x, x});
+    EXPECT_EQ(coupled.countStates(coupled.getReachableStates()), 2.0);
+    EXPECT_FALSE(coupled.updateTransitionFunctions({{0, coupled.neg(x)}}));
+    EXPECT_FALSE(coupled.isReachable({true, true}));
+    EXPECT_EQ(coupled.countStates(coupled.getReachableStates()), 3.0);
+}
+
+TEST_F(ReachabilityTest, BenchLoaderTest) { /* NOLINT */
+    BenchParser parser(std::string(VDS_BENCHMARK_DIR) + "/iscas89/s27.bench");
+    CircuitToReachability loader;
+    auto s27 = loader.GenerateModel(parser.GetSortedCircuit());
+    EXPECT_EQ(loader.GetStateLabels().size(), 3u);
+    EXPECT_EQ(loader.GetInputLabels().size(), 4u);
+    EXPECT_TRUE(s27->isReachable({false, false, false}));
+    EXPECT_EQ(s27->countStates(s27->getReachableStates()), 6.0);
+
+    // the shipped sequential circuits reach the state counts given in their headers
+    {
+        BenchParser arbParser(std::string(VDS_BENCHMARK_DIR) + "/sequential/arb16.bench");
+        CircuitToReachability arbLoader;
+        auto arb16 = arbLoader.GenerateModel(arbParser.GetSortedCircuit());
+        EXPECT_EQ(arbLoader.GetStateLabels().size(), 32u);
+        EXPECT_EQ(arb16->countStates(arb16->getReachableStates()), 33.0);
+    }
+    BenchParser lfsrParser(std::string(VDS_BENCHMARK_DIR) + "/sequential/lfsr32.bench");
+    auto lfsr32 = loader.GenerateModel(lfsrParser.GetSortedCircuit());
+    EXPECT_EQ(lfsr32->countStates(lfsr32->getReachableStates()), 4294967296.0);
+
+    // unsupported gates are rejected, also when they have a single input like a buffer
+    const list_of_circuit_t circuit = {{0, "G0", INPUT_GATE_T, {}, {1}},
+                                       {1, "G1", "XNOR", {0}, {2}},
+                                       {2, "G0", FLIP_FLOP_GATE_T, {1}, {}}};
+    EXPECT_THROW(loader.GenerateModel(circuit), std::runtime_error);
+}
+
+TEST_F(ReachabilityTest, ImagePoolTest) { /* NOLINT */
+    ClassProject::ImagePool pool(3);
+    ASSERT_EQ(pool.size(), 3u);
+    std::vector<int> hits(3, 0);
+    pool.run([&hits](const unsigned int w) { hits[w]++; });
+    EXPECT_EQ(hits, (std::vector<int>{1, 1, 1}));
+
+    // a throwing task reaches the caller instead of terminating, the other threads still run
+    EXPECT_THROW(pool.run([&hits](const unsigned int w) {
+        if (w == 1) {
+            throw std::out_of_range("worker 1");
+        }
+        hits[w]++;
+    }), std::out_of_range);
+    EXPECT_EQ(hits, (std::vector<int>{2, 1, 2}));
+    EXPECT_THROW(pool.run([](unsigned int) { throw std::bad_alloc(); }), std::bad_alloc);
+
+    // the error is not kept for the next run
+    pool.run([&hits](const unsigned int w) { hits[w]++; });
+    EXPECT_EQ(hits, (std::vector<int>{3, 2, 3}));
+}
+
 #endif
@@ -7,7 +7,9 @@
 
 #include <gtest/gtest.h>
 #include "../Manager.h"
+#include "../BDD.h"
 #include <memory>
+#include <thread>
 
 using namespace ClassProject;
 
@@ -309,6 +311,13 @@ public:
         // returns the label of the given BDD_ID
         EXPECT_EQ(m->getTopVarName(m->False()), "False");
         EXPECT_EQ(m->getTopVarName(m->True()), "True");
+
+        // variables keep the label they were created with
+        EXPECT_EQ(m->getTopVarName(a), "a");
+        EXPECT_EQ(m->getTopVarName(d), "d");
+        EXPECT_EQ(m->getTopVarName(c_and_neg_d_id), "c");
+        EXPECT_EQ(m->getTopVarName(m->createVar("enable_long_label")), "enable_long_label");
+        EXPECT_EQ(m->getTopVarName(a), "a");
     }
 
     TEST_F(ManagerTest, findNodes) {
@@ -355,4 +364,482 @@ public:
         m->visualizeBDD("ROBDD.txt",f);
     }
 
+    TEST_F(ManagerTest, stats) {
+        const ManagerStats before = m->stats();
+#ifdef VDS_MANAGER_STATS
+        EXPECT_TRUE(before.enabled);
+        EXPECT_EQ(before.peakNodes, m->uniqueTableSize());
+
+        // A repeated non-trivial ite is answered by the computed table
+        m->ite(a_or_b_id, c, d);
+        m->ite(a_or_b_id, c, d);
+        const ManagerStats after = m->stats();
+        EXPECT_GT(after.iteCalls, before.iteCalls);
+        EXPECT_GT(after.computedHits, before.computedHits);
+        EXPECT_EQ(after.computedLookups, after.computedHits + after.computedMisses);
+        EXPECT_LE(after.uniqueMaxProbeLength, after.uniqueProbeLength);
+        EXPECT_EQ(after.peakNodes, m->uniqueTableSize());
+#else
+        EXPECT_FALSE(before.enabled);
+        EXPECT_EQ(before.iteCalls, 0);
+#endif
+    }
+
+    TEST_F(ManagerTest, invalidIdTest) {
+        // user supplied IDs are validated at the API boundary in every build type
+        const BDD_ID unknown = m->uniqueTableSize();
+        EXPECT_THROW(m->topVar(unknown), std::out_of_range);
+        EXPECT_THROW(m->isVariable(unknown), std::out_of_range);
+        EXPECT_THROW(m->coFactorTrue(unknown), std::out_of_range);
+        EXPECT_THROW(m->coFactorFalse(a, unknown), std::out_of_range);
+        EXPECT_THROW(m->ite(a, unknown, b), std::out_of_range);
+        EXPECT_THROW(m->and2(unknown, b), std::out_of_range);
+        EXPECT_THROW(m->xor2(a, unknown), std::out_of_range);
+        EXPECT_EQ(m->uniqueTableSize(), unknown);
+    }
+
+    TEST_F(ManagerTest, canonicalTriplesTest) {
+        BDD_ID i = d, t = c, e = m->False();
+        m->standard_triples(i, t, e);
+        EXPECT_EQ(i, c);
+        EXPECT_EQ(t, d);
+        EXPECT_EQ(e, m->False());
+
+        i = c; t = c; e = d;
+        m->standard_triples(i, t, e);
+        EXPECT_EQ(i, c);
+        EXPECT_EQ(t, m->True());
+        EXPECT_EQ(e, d);
+
+        // commutative AND/OR share a single computed table entry
+#ifdef VDS_MANAGER_STATS
+        const ManagerStats before = m->stats();
+#endif
+        EXPECT_EQ(m->and2(d, c), m->and2(c, d));
+        EXPECT_EQ(m->or2(d, c), m->or2(c, d));
+        EXPECT_TRUE(m->computedTableContains(uTableRow(c, d, m->False())));
+        EXPECT_FALSE(m->computedTableContains(uTableRow(d, c, m->False())));
+        EXPECT_TRUE(m->computedTableContains(uTableRow(c, m->True(), d)));
+        EXPECT_FALSE(m->computedTableContains(uTableRow(d, m->True(), c)));
+#ifdef VDS_MANAGER_STATS
+        const ManagerStats after = m->stats();
+        EXPECT_EQ(after.computedMisses - before.computedMisses, 2);
+        EXPECT_EQ(after.computedHits - before.computedHits, 2);
+        EXPECT_GE(after.iteCanonicalized - before.iteCanonicalized, 2);
+#endif
+    }
+
+    TEST_F(ManagerTest, bddHandleOperators) {
+        const BDD A(*m, a), B(*m, b), C(*m, c);
+
+        EXPECT_EQ((A & B).id(), a_and_b_id);
+        EXPECT_EQ((A | B).id(), a_or_b_id);
+        EXPECT_EQ((A ^ B).id(), a_xor_b);
+        EXPECT_EQ((~A).id(), neg_a_id);
+        EXPECT_EQ(ite(A, B, C).id(), m->ite(a, b, c));
+
+        BDD acc = A;
+        acc &= B;
+        EXPECT_EQ(acc, A & B);
+        acc |= C;
+        EXPECT_EQ(acc.id(), m->or2(a_and_b_id, c));
+
+        Manager other;
+        const BDD foreign(other, other.createVar("a"));
+        EXPECT_THROW(A & foreign, std::runtime_error);
+    }
+
+    TEST_F(ManagerTest, bddHandleReferenceCounting) {
+        const BDD_ID f = m->and2(a_or_b_id, c);
+        EXPECT_EQ(m->refCount(f), 0);
+        {
+            BDD first(*m, f);
+            EXPECT_EQ(m->refCount(f), 1);
+            BDD copy = first;
+            EXPECT_EQ(m->refCount(f), 2);
+            BDD moved = std::move(copy);
+            EXPECT_EQ(m->refCount(f), 2);
+            moved = BDD(*m, a);
+            EXPECT_EQ(m->refCount(f), 1);
+        }
+        EXPECT_EQ(m->refCount(f), 0);
+    }
+
+    TEST_F(ManagerTest, garbageCollect) {
+        const BDD kept = BDD(*m, a) & BDD(*m, c);
+        const BDD_ID dropped = m->xor2(c, d);
+        const size_t size = m->uniqueTableSize();
+
+        const size_t reclaimed = m->garbageCollect();
+        EXPECT_GT(reclaimed, 0);
+        EXPECT_EQ(m->uniqueTableSize(), size - reclaimed);
+        EXPECT_FALSE(m->isValidId(dropped));
+        EXPECT_THROW(m->topVar(dropped), std::out_of_range);
+
+        // referenced functions, variables and terminals survive
+        EXPECT_TRUE(m->isValidId(kept.id()));
+        EXPECT_TRUE(m->isVariable(d));
+        EXPECT_EQ(m->and2(a, c), kept.id());
+        EXPECT_EQ(m->coFactorTrue(kept.id(), a), c);
+
+        // reclaimed slots are reused and the rebuilt function is still canonical
+        const BDD_ID rebuilt = m->xor2(c, d);
+        EXPECT_LT(rebuilt, m->getUniqueTable().size());
+        EXPECT_EQ(m->xor2(d, c), rebuilt);
+        EXPECT_EQ(m->coFactorTrue(rebuilt, c), m->neg(d));
+    }
+
+    TEST_F(ManagerTest, breadthFirstIte) {
+        // the breadth-first engine returns the same canonical nodes as the recursive one
+        const std::vector<BDD_ID> operands = {m->False(), m->True(), a, neg_b_id, a_xor_b, complexBDD,
+                                              c_and_neg_d_id, m->or2(a_and_b_id, neg_d_id)};
+        for (const BDD_ID i : operands) {
+            for (const BDD_ID t : operands) {
+                for (const BDD_ID e : operands) {
+                    EXPECT_EQ(m->ite(i, t, e, ApplyMode::BreadthFirst), m->ite(i, t, e));
+                }
+            }
+        }
+
+        // on a manager without cached results, too
+        Manager bfs, dfs;
+        std::vector<BDD_ID> vb, vd;
+        for (int k = 0; k < 8; ++k) {
+            vb.push_back(bfs.createVar("v" + std::to_string(k)));
+            vd.push_back(dfs.createVar("v" + std::to_string(k)));
+        }
+        BDD_ID fb = bfs.True(), fd = dfs.True();
+        for (int k = 0; k < 4; ++k) {
+            fb = bfs.and2(fb, bfs.xor2(vb[k], vb[7 - k]), ApplyMode::BreadthFirst);
+            fd = dfs.and2(fd, dfs.xor2(vd[k], vd[7 - k]));
+        }
+        EXPECT_EQ(bfs.uniqueTableSize(), dfs.uniqueTableSize());
+        std::set<BDD_ID> nb, nd;
+        bfs.findNodes(fb, nb);
+        dfs.findNodes(fd, nd);
+        EXPECT_EQ(nb.size(), nd.size());
+        EXPECT_EQ(bfs.or2(fb, vb[0], ApplyMode::BreadthFirst), bfs.or2(fb, vb[0]));
+    }
+
+    TEST_F(ManagerTest, checkpointRollback) {
+        const size_t size = m->uniqueTableSize();
+        const BDD_ID old_and = m->and2(a, b);
+
+        const Checkpoint outer = m->checkpoint();
+        const BDD_ID x = m->createVar("x");
+        const BDD_ID f = m->xor2(m->or2(c, x), d);
+        const size_t built = m->uniqueTableSize();
+
+        const Checkpoint inner = m->checkpoint();
+        const BDD_ID g = m->and2(f, m->neg(a));
+        EXPECT_GT(m->uniqueTableSize(), built);
+        m->rollback(inner);
+        EXPECT_EQ(m->uniqueTableSize(), built);
+        EXPECT_FALSE(m->isValidId(g));
+        EXPECT_EQ(m->xor2(m->or2(c, x), d), f);
+
+        m->rollback(outer);
+        EXPECT_EQ(m->uniqueTableSize(), size);
+        EXPECT_FALSE(m->isValidId(x));
+        EXPECT_FALSE(m->isValidId(f));
+        EXPECT_THROW(m->rollback(outer), std::runtime_error);
+
+        // results from before the checkpoint stay intact, removed ones are rebuilt from scratch
+        EXPECT_EQ(m->and2(a, b), old_and);
+        const BDD_ID y = m->createVar("y");
+        EXPECT_EQ(y, x);
+        EXPECT_EQ(m->getTopVarName(y), "y");
+        EXPECT_EQ(m->coFactorTrue(m->xor2(m->or2(c, y), d), c), m->neg(d));
+
+        // a handle on a node created after the checkpoint blocks the rollback, commit keeps the nodes
+        const Checkpoint held = m->checkpoint();
+        const BDD kept = BDD(*m, a) & BDD(*m, y);
+        EXPECT_THROW(m->rollback(held), std::runtime_error);
+        m->commit(held);
+        EXPECT_TRUE(m->isValidId(kept.id()));
+    }
+
+    TEST_F(ManagerTest, forkSharesFrozenBase) {
+        const BDD_ID prefix = m->and2(complexBDD, a_xor_b);
+        const size_t size = m->uniqueTableSize();
+
+        std::vector<std::unique_ptr<Manager>> forks;
+        for (int k = 0; k < 4; ++k) {
+            forks.push_back(m->fork());
+        }
+        EXPECT_EQ(m->frozenSize(), m->getUniqueTable().size() + size);
+        EXPECT_EQ(m->getUniqueTable().size(), 0);
+
+        // independent continuations in parallel, each on its own overlay
+        std::vector<BDD_ID> results(forks.size());
+        std::vector<std::thread> jobs;
+        for (size_t k = 0; k < forks.size(); ++k) {
+            jobs.emplace_back([&, k] {
+                Manager &f = *forks[k];
+                const BDD_ID x = f.createVar("x" + std::to_string(k));
+                results[k] = f.xor2(f.or2(prefix, x), k % 2 ? c : d);
+            });
+        }
+        for (std::thread &job : jobs) {
+            job.join();
+        }
+
+        for (size_t k = 0; k < forks.size(); ++k) {
+            Manager &f = *forks[k];
+            // shared nodes and cached results are found in the base
+            EXPECT_EQ(f.and2(complexBDD, a_xor_b), prefix);
+            EXPECT_EQ(f.uniqueTableSize(), size + f.getUniqueTable().size());
+            EXPECT_EQ(f.getTopVarName(f.topVar(prefix)), "a");
+            EXPECT_EQ(f.getTopVarName(size), "x" + std::to_string(k));
+            EXPECT_EQ(f.coFactorTrue(results[k], size), f.neg(k % 2 ? c : d));
+        }
+        EXPECT_EQ(forks[0]->getUniqueTable(), forks[2]->getUniqueTable());
+
+        // the parent is unaffected and keeps building, garbage collection spares the base
+        EXPECT_FALSE(m->isValidId(size));
+        const BDD_ID fresh = m->xor2(prefix, d);
+        EXPECT_GE(fresh, size);
+        EXPECT_GT(m->garbageCollect(), 0);
+        EXPECT_TRUE(m->isValidId(prefix));
+        EXPECT_FALSE(m->isValidId(fresh));
+        EXPECT_EQ(m->xor2(d, prefix), m->xor2(prefix, d));
+        EXPECT_EQ(m->or2(m->and2(m->xor2(prefix, d), d), m->and2(prefix, m->neg(d))), m->xor2(prefix, d));
+
+        // a fork of a fork stacks a layer on the shared base
+        const std::unique_ptr<Manager> nested = forks[1]->fork();
+        EXPECT_EQ(nested->frozenSize(), forks[1]->uniqueTableSize());
+        EXPECT_EQ(nested->xor2(nested->or2(prefix, size), c), results[1]);
+
+        const Checkpoint open = m->checkpoint();
+        EXPECT_THROW(m->fork(), std::runtime_error);
+        m->commit(open);
+    }
+
+    TEST_F(ManagerTest, forkChainsFrozenLayers) {
+        // every fork adds a layer, nodes and cached results of all layers stay visible, also once the
+        // chain gets deep enough to be flattened
+        std::vector<std::unique_ptr<Manager>> generations;
+        std::vector<BDD_ID> built{complexBDD}, vars;
+        Manager *current = m.get();
+        for (int k = 0; k < 12; ++k) {
+            vars.push_back(current->createVar("g" + std::to_string(k)));
+            built.push_back(current->xor2(built.back(), current->and2(vars.back(), k % 2 ? a : d)));
+            const size_t frozen = current->frozenSize();
+            generations.push_back(current->fork());
+            current = generations.back().get();
+            EXPECT_GT(current->frozenSize(), frozen);
+            EXPECT_TRUE(current->getUniqueTable().empty());
+        }
+        const size_t size = current->uniqueTableSize();
+        for (int k = 0; k < 12; ++k) {
+            EXPECT_EQ(current->xor2(built[k], current->and2(vars[k], k % 2 ? a : d)), built[k + 1]);
+            EXPECT_EQ(current->getTopVarName(vars[k]), "g" + std::to_string(k));
+        }
+        EXPECT_EQ(current->uniqueTableSize(), size);
+        EXPECT_EQ(current->and2(current->xor2(built.back(), b), b), current->and2(current->neg(built.back()), b));
+        EXPECT_GT(current->uniqueTableSize(), size);
+    }
+
+    TEST_F(ManagerTest, transferBetweenManagers) {
+        // same order: the DAG is copied node by node
+        Manager same;
+        std::unordered_map<BDD_ID, BDD_ID> identity;
+        for (const std::string label : {"a", "b", "c", "d"}) {
+            identity.emplace(identity.size() + 2, same.createVar(label));
+        }
+        const BDD_ID copy = Manager::transfer(*m, complexBDD, same, identity);
+        std::set<BDD_ID> src_nodes, dst_nodes;
+        m->findNodes(complexBDD, src_nodes);
+        same.findNodes(copy, dst_nodes);
+        EXPECT_EQ(src_nodes.size(), dst_nodes.size());
+        EXPECT_EQ(Manager::transfer(same, copy, *m, {{2, a}, {3, b}, {4, c}, {5, d}}), complexBDD);
+
+        // reversed order: the result is reordered, but denotes the same function
+        Manager reversed;
+        const BDD_ID rd = reversed.createVar("d"), rc = reversed.createVar("c");
+        const BDD_ID rb = reversed.createVar("b"), ra = reversed.createVar("a");
+        const std::unordered_map<BDD_ID, BDD_ID> swap{{a, ra}, {b, rb}, {c, rc}, {d, rd}};
+        const BDD_ID moved = Manager::transfer(*m, a_xor_b, reversed, swap);
+        EXPECT_EQ(moved, reversed.xor2(ra, rb));
+        EXPECT_EQ(reversed.topVar(moved), rb);
+        const BDD_ID back = Manager::transfer(reversed, Manager::transfer(*m, complexBDD, reversed, swap), *m,
+                                              {{rd, d}, {rc, c}, {rb, b}, {ra, a}});
+        EXPECT_EQ(back, complexBDD);
+
+        EXPECT_EQ(Manager::transfer(*m, m->True(), reversed, {}), reversed.True());
+        EXPECT_THROW(Manager::transfer(*m, a_and_b_id, reversed, {{a, ra}}), std::out_of_range);
+    }
+
+    TEST_F(ManagerTest, approximations) {
+        std::vector<BDD_ID> v;
+        for (int k = 0; k < 8; ++k) {
+            v.push_back(m->createVar("v" + std::to_string(k)));
+        }
+        BDD_ID f = m->False();
+        for (int k = 0; k < 8; k += 2) {
+            f = m->or2(f, m->and2(v[k], m->xor2(v[k + 1], v[(k + 3) % 8])));
+        }
+        const size_t size = m->nodeCount(f);
+        std::set<BDD_ID> nodes;
+        m->findNodes(f, nodes);
+        EXPECT_EQ(size, nodes.size());
+
+        for (const ApproxMethod method : {ApproxMethod::HeavyBranch, ApproxMethod::ShortPath, ApproxMethod::Remap}) {
+            for (const size_t threshold : {size_t{2}, size_t{4}, size_t{7}, size_t{12}, size / 2, size - 1}) {
+                const BDD_ID under = m->underApprox(f, threshold, method);
+                EXPECT_LE(m->nodeCount(under), threshold);
+                EXPECT_EQ(m->and2(under, m->neg(f)), m->False());
+
+                const BDD_ID over = m->overApprox(f, threshold, method);
+                EXPECT_LE(m->nodeCount(over), threshold);
+                EXPECT_EQ(m->and2(f, m->neg(over)), m->False());
+            }
+            EXPECT_EQ(m->underApprox(f, size, method), f);
+            EXPECT_NE(m->underApprox(f, size / 2, method), m->False());
+        }
+
+        // heavy branch subsetting drops the branch with fewer minterms
+        const BDD_ID skewed = m->ite(v[0], m->or2(v[1], v[2]), m->and2(v[3], v[4]));
+        EXPECT_EQ(m->heavyBranchSubset(skewed, 5), m->and2(v[0], m->or2(v[1], v[2])));
+        EXPECT_EQ(m->heavyBranchSubset(skewed, 4), m->and2(v[0], v[1]));
+        // short path subsetting keeps the shortest cube
+        EXPECT_EQ(m->shortPathSubset(m->or2(m->and2(v[0], v[1]), m->and2(v[2], m->and2(v[3], v[4]))), 4),
+                  m->and2(v[0], v[1]));
+
+        // parity shares every node: far fewer nodes than paths, the size bounds alone do not decide
+        BDD_ID parity = m->False();
+        for (int k = 0; k < 24; ++k) {
+            parity = m->xor2(parity, m->createVar("p" + std::to_string(k)));
+        }
+        EXPECT_EQ(m->heavyBranchSubset(parity, m->nodeCount(parity)), parity);
+        const BDD_ID subset = m->heavyBranchSubset(parity, 40);
+        EXPECT_NE(subset, m->False());
+        EXPECT_LE(m->nodeCount(subset), 40);
+        EXPECT_EQ(m->and2(subset, m->neg(parity)), m->False());
+    }
+
+    TEST_F(ManagerTest, andLimit) {
+        std::vector<BDD_ID> v;
+        for (int k = 0; k < 8; ++k) {
+            v.push_back(m->createVar("v" + std::to_string(k)));
+        }
+        const BDD_ID low_half = m->xor2(m->xor2(v[0], v[2]), v[4]);
+        const BDD_ID high_half = m->or2(m->and2(v[1], v[3]), m->and2(v[5], v[7]));
+        const size_t size = m->uniqueTableSize();
+
+        // aborted: nothing of the partial result is left behind
+        EXPECT_EQ(m->andLimit(low_half, high_half, 2), InvalidId);
+        EXPECT_EQ(m->uniqueTableSize(), size);
+
+        // enough room: same node as and2, created within the limit
+        const BDD_ID result = m->andLimit(low_half, high_half, 100);
+        EXPECT_NE(result, InvalidId);
+        const size_t used = m->uniqueTableSize() - size;
+        EXPECT_LE(used, 100);
+        EXPECT_EQ(m->and2(low_half, high_half), result);
+        EXPECT_EQ(m->uniqueTableSize(), size + used);
+
+        // existing results need no new nodes, the manager keeps working after an abort
+        EXPECT_EQ(m->andLimit(low_half, high_half, 0), result);
+        EXPECT_EQ(m->andLimit(a, m->True(), 0), a);
+        EXPECT_EQ(m->andLimit(m->xor2(v[0], v[6]), m->or2(v[2], v[3]), 0), InvalidId);
+        EXPECT_EQ(m->coFactorTrue(m->and2(m->xor2(v[0], v[6]), v[2]), v[2]), m->xor2(v[0], v[6]));
+        EXPECT_THROW(m->andLimit(a, InvalidId, 10), std::out_of_range);
+
+        // breadth-first: same limit semantics, an abort in the reduction phase is rolled back as well
+        const BDD_ID wide = m->xor2(m->xor2(v[1], v[3]), v[5]);
+        const BDD_ID narrow = m->or2(m->and2(v[0], v[2]), m->and2(v[4], v[6]));
+        const size_t before = m->uniqueTableSize();
+        EXPECT_EQ(m->andLimit(wide, narrow, 2, ApplyMode::BreadthFirst), InvalidId);
+        EXPECT_EQ(m->uniqueTableSize(), before);
+        const BDD_ID bfs = m->andLimit(wide, narrow, 100, ApplyMode::BreadthFirst);
+        EXPECT_NE(bfs, InvalidId);
+        EXPECT_EQ(m->and2(wide, narrow), bfs);
+        EXPECT_EQ(m->andLimit(wide, narrow, 0, ApplyMode::BreadthFirst), bfs);
+    }
+
+    TEST_F(ManagerTest, restrict) {
+        // agrees with f on the care set
+        const std::vector<BDD_ID> functions = {a_xor_b, complexBDD, c_and_neg_d_id, m->or2(a_and_b_id, neg_d_id)};
+        const std::vector<BDD_ID> cares = {a, neg_b_id, a_or_b_id, m->xor2(c, d), complexBDD, m->True()};
+        for (const BDD_ID f : functions) {
+            for (const BDD_ID care : cares) {
+                const BDD_ID g = m->restrict(f, care);
+                EXPECT_EQ(m->and2(g, care), m->and2(f, care));
+                EXPECT_LE(m->nodeCount(g), m->nodeCount(f) + 1);
+            }
+        }
+        EXPECT_EQ(m->restrict(a_and_b_id, a), b);
+        EXPECT_EQ(m->restrict(m->and2(c, d), d), c);
+        EXPECT_EQ(m->restrict(m->and2(c, d), m->and2(a, d)), c);
+        EXPECT_EQ(m->restrict(complexBDD, complexBDD), m->True());
+        EXPECT_EQ(m->restrict(complexBDD, m->False()), complexBDD);
+    }
+
+    TEST_F(ManagerTest, existsAndExists) {
+        const BDD_ID cube_a = a;
+        const BDD_ID cube_bd = m->and2(b, d);
+        EXPECT_EQ(m->exists(a_and_b_id, cube_a), b);
+        EXPECT_EQ(m->exists(a_xor_b, cube_a), m->True());
+        EXPECT_EQ(m->exists(c_and_neg_d_id, cube_bd), c);
+        EXPECT_EQ(m->exists(complexBDD, m->True()), complexBDD);
+
+        // andExists matches quantifying the explicit conjunction
+        const std::vector<BDD_ID> operands = {a, neg_b_id, a_xor_b, complexBDD, c_and_neg_d_id,
+                                              m->or2(a_and_b_id, neg_d_id), m->xor2(b, c)};
+        const std::vector<BDD_ID> cubes = {m->True(), cube_a, cube_bd, m->and2(a, m->and2(c, d)), m->and2(b, c)};
+        for (const BDD_ID f : operands) {
+            for (const BDD_ID g : operands) {
+                for (const BDD_ID cube : cubes) {
+                    EXPECT_EQ(m->andExists(f, g, cube), m->exists(m->and2(f, g), cube));
+                }
+            }
+        }
+    }
+
+    TEST_F(ManagerTest, vectorCompose) {
+        // simultaneous: swapping a and b leaves symmetric functions unchanged
+        EXPECT_EQ(m->vectorCompose(a_xor_b, {{a, b}, {b, a}}), a_xor_b);
+        EXPECT_EQ(m->vectorCompose(a_and_neg_b_id, {{a, b}, {b, a}}), m->and2(b, neg_a_id));
+        EXPECT_EQ(m->vectorCompose(a_and_b_id, {{b, m->xor2(c, d)}}), m->and2(a, m->xor2(c, d)));
+        EXPECT_EQ(m->vectorCompose(complexBDD, {}), complexBDD);
+        EXPECT_EQ(m->vectorCompose(c_and_neg_d_id, {{d, m->False()}}), c);
+        EXPECT_THROW(m->vectorCompose(a, {{b, InvalidId}}), std::out_of_range);
+    }
+
+    TEST_F(ManagerTest, intersects) {
+        const std::vector<BDD_ID> operands = {m->False(), m->True(), a, neg_a_id, a_xor_b, a_and_b_id, complexBDD,
+                                              c_and_neg_d_id, m->and2(c, d), m->neg(complexBDD)};
+        for (const BDD_ID f : operands) {
+            for (const BDD_ID g : operands) {
+                EXPECT_EQ(m->intersects(f, g), m->and2(f, g) != m->False());
+            }
+        }
+        // no nodes are created
+        const BDD_ID big = m->xor2(m->xor2(a, c), m->xor2(b, d));
+        const BDD_ID a_xnor_b = m->neg(a_xor_b), not_big = m->neg(big);
+        const size_t size = m->uniqueTableSize();
+        EXPECT_TRUE(m->intersects(big, a_xnor_b));
+        EXPECT_FALSE(m->intersects(big, not_big));
+        EXPECT_EQ(m->uniqueTableSize(), size);
+    }
+
+    TEST_F(ManagerTest, cube) {
+        EXPECT_EQ(m->cube({}), m->True());
+        EXPECT_EQ(m->cube({b, a}), a_and_b_id);
+        EXPECT_EQ(m->cube({a, b}, {true, false}), a_and_neg_b_id);
+        EXPECT_EQ(m->cube({d, c}, {false, true}), c_and_neg_d_id);
+        EXPECT_EQ(m->cube({a, b, c, d}, {false, true, false, true}),
+                  m->and2(m->and2(neg_a_id, b), m->and2(m->neg(c), d)));
+
+        // no ite calls: only the cube nodes themselves are new
+        const size_t size = m->uniqueTableSize();
+        m->cube({a, b, c, d}, {true, false, true, false});
+        EXPECT_LE(m->uniqueTableSize(), size + 4);
+
+        EXPECT_THROW(m->cube({a, b}, {true}), std::runtime_error);
+        EXPECT_THROW(m->cube({a, a}), std::runtime_error);
+        EXPECT_THROW(m->cube({a_and_b_id}), std::runtime_error);
+    }
+
 #endif